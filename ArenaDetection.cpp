@@ -1,30 +1,66 @@
 #include "arena_detector.h"
 #include <opencv2/aruco.hpp>
+#include <algorithm>
 #include <iostream>
 
 using namespace cv;
 using namespace std;
 
-Mat detectArenaMarkers(const Mat& frame, Mat& displayFrame, const Mat& cameraMatrix, const Mat& distCoeffs, float markerLength, const vector<Ball>& balls) {
-    vector<int> ids;
-    vector<vector<Point2f>> corners;
-
-    // --- FIX: Use the modern ArucoDetector API ---
-    // 1. Get the dictionary object
-    cv::aruco::Dictionary dictionary = aruco::getPredefinedDictionary(aruco::DICT_4X4_50);
-    // 2. Create an ArucoDetector instance
-    cv::aruco::ArucoDetector detector(dictionary);
-    // 3. Use the detector to find markers
-    detector.detectMarkers(frame, corners, ids);
-    // --- END FIX ---
-
-    map<int, Point2f> marker_centers;
-    if (!ids.empty()) {
-        for (size_t i = 0; i < ids.size(); ++i) {
-            if (ids[i] >= 46 && ids[i] <= 49) { // Arena markers
-                Point2f center = (corners[i][0] + corners[i][1] + corners[i][2] + corners[i][3]) / 4;
-                marker_centers[ids[i]] = center;
-            }
+namespace {
+
+constexpr int ARENA_MARKER_COUNT = LAST_ARENA_MARKER_ID - FIRST_ARENA_MARKER_ID + 1;
+
+// Top-down positions of markers 46, 47, 48, 49
+const vector<Point2f> ARENA_DST_POINTS = {Point2f(0, 480), Point2f(0, 0), Point2f(480, 0), Point2f(480, 480)};
+
+float median(vector<float>& values) {
+    auto mid = values.begin() + values.size() / 2;
+    nth_element(values.begin(), mid, values.end());
+    return *mid;
+}
+
+Point2f medianPoint(const vector<Point2f>& points) {
+    vector<float> xs, ys;
+    for (const auto& p : points) {
+        xs.push_back(p.x);
+        ys.push_back(p.y);
+    }
+    return Point2f(median(xs), median(ys));
+}
+
+void drawArenaOutline(Mat& displayFrame, const vector<Point2f>& centers) {
+    // Drawn 47 -> 48 -> 49 -> 46
+    vector<Point> outline = {centers[1], centers[2], centers[3], centers[0]};
+    polylines(displayFrame, outline, true, Scalar(255, 0, 255), 2);
+}
+
+} // namespace
+
+ArenaDetector::ArenaDetector(const ArenaConfig& config)
+    : config(config), samples(ARENA_MARKER_COUNT) {}
+
+bool ArenaDetector::needsMarkers() const {
+    return !locked || framesSinceCheck >= config.verifyInterval;
+}
+
+void ArenaDetector::unlock() {
+    locked = false;
+    for (auto& cornerSamples : samples) cornerSamples.clear();
+}
+
+Mat ArenaDetector::update(const MarkerDetections& markers, Mat& displayFrame, const vector<Ball>& balls) {
+    vector<Point2f> centers(ARENA_MARKER_COUNT);
+    vector<bool> seen(ARENA_MARKER_COUNT, false);
+    int seenCount = 0;
+    if (!markers.ids.empty()) {
+        aruco::drawDetectedMarkers(displayFrame, markers.corners, markers.ids);
+
+        for (size_t i = 0; i < markers.ids.size(); ++i) {
+            const vector<Point2f>& c = markers.corners[i];
+            int corner = markers.ids[i] - FIRST_ARENA_MARKER_ID;
+            centers[corner] = (c[0] + c[1] + c[2] + c[3]) / 4;
+            if (!seen[corner]) ++seenCount;
+            seen[corner] = true;
         }
     }
 
@@ -33,18 +69,52 @@ Mat detectArenaMarkers(const Mat& frame, Mat& displayFrame, const Mat& cameraMat
         circle(displayFrame, ball.center, ball.radius, Scalar(0, 255, 255), 2);
     }
 
-    if (marker_centers.count(46) && marker_centers.count(47) && marker_centers.count(48) && marker_centers.count(49)) {
-        vector<Point2f> src_pts = {marker_centers[46], marker_centers[47], marker_centers[48], marker_centers[49]};
-        vector<Point2f> dst_pts = {Point2f(0, 480), Point2f(0, 0), Point2f(480, 0), Point2f(480, 480)};
+    // --- LOCKED: reuse the frozen homography, checking visible corners for drift ---
+    if (locked) {
+        ++framesSinceCheck;
+        if (seenCount > 0) {
+            float drift = 0;
+            for (int i = 0; i < ARENA_MARKER_COUNT; ++i) {
+                if (seen[i]) drift = max(drift, static_cast<float>(norm(centers[i] - lockedCenters[i])));
+            }
+            framesSinceCheck = 0;
+            if (drift > config.maxDriftPx) {
+                cout << "[Arena] Corners drifted " << drift << " px, re-estimating homography." << endl;
+                unlock();
+            }
+        }
+        if (locked) {
+            drawArenaOutline(displayFrame, lockedCenters);
+            return lockedH;
+        }
+    }
 
-        Mat h = findHomography(src_pts, dst_pts);
+    // --- UNLOCKED: per-frame homography, which needs all four corners ---
+    if (seenCount < ARENA_MARKER_COUNT) {
+        return Mat();
+    }
 
-        vector<Point2f> frame_corners_f = {marker_centers[47], marker_centers[48], marker_centers[49], marker_centers[46]};
-        vector<Point> frame_corners_i(frame_corners_f.begin(), frame_corners_f.end());
-        polylines(displayFrame, frame_corners_i, true, Scalar(255, 0, 255), 2);
+    Mat h = findHomography(centers, ARENA_DST_POINTS);
+    drawArenaOutline(displayFrame, centers);
 
-        return h;
+    if (config.lock) {
+        for (int i = 0; i < ARENA_MARKER_COUNT; ++i) {
+            samples[i].push_back(centers[i]);
+        }
+        if (static_cast<int>(samples[0].size()) >= config.lockFrames) {
+            // The median of each corner rejects frames with a bad marker fit
+            lockedCenters.clear();
+            for (const auto& cornerSamples : samples) {
+                lockedCenters.push_back(medianPoint(cornerSamples));
+            }
+            lockedH = findHomography(lockedCenters, ARENA_DST_POINTS);
+            locked = true;
+            framesSinceCheck = 0;
+            for (auto& cornerSamples : samples) cornerSamples.clear();
+            cout << "[Arena] Homography locked after " << config.lockFrames << " frames." << endl;
+            return lockedH;
+        }
     }
 
-    return Mat();
-}
\ No newline at end of file
+    return h;
+}
@@ -1,42 +1,116 @@
 #include "ball_detector.h"
 #include <opencv2/opencv.hpp>
+#include <iostream>
 #include "json.hpp"
 using json = nlohmann::json;
 using namespace cv;
 using namespace std;
 
-vector<Ball> detectOrangeBalls(const Mat& frame) {
-    Mat hsv, mask;
-    cvtColor(frame, hsv, COLOR_BGR2HSV);
+BallDetector::BallDetector(const BallConfig& config)
+    : lut(config.lutBits), minArea(config.minArea), minCircularity(config.minCircularity),
+      kernel(getStructuringElement(MORPH_ELLIPSE, Size(5, 5))) {
+    if (lut.load(config.lutPath)) {
+        cout << "[Balls] Loaded colour LUT from " << config.lutPath << endl;
+    } else {
+        lut.build(config.lowerHSV, config.upperHSV);
+        cout << "[Balls] Built colour LUT from HSV bounds." << endl;
+    }
+}
+
+vector<Ball> BallDetector::detect(const Mat& frame) {
+    vector<Ball> balls;
+    findBalls(frame, Point2f(0, 0), balls);
+    return balls;
+}
+
+vector<Ball> BallDetector::detect(const Mat& frame, const vector<Rect>& windows) {
+    vector<Ball> balls;
+    for (const auto& window : windows) {
+        // frame(window) is a header into the frame, not a copy
+        findBalls(frame(window), Point2f(window.x, window.y), balls);
+    }
+    return balls;
+}
+
+namespace {
+
+// A filled disc of radius r has mu20 + mu02 = area * r^2 / 2, so this is its
+// radius, and the circularity is 1 for a disc and lower for elongated or
+// ragged blobs.
+float radiusOf(double area, double spread) {
+    return static_cast<float>(sqrt(2.0 * spread / area));
+}
 
-    // These HSV values seem to be working for you, so we'll keep them.
-    Scalar lowerOrange(0, 119, 210);
-    Scalar upperOrange(51, 196, 255);
-    inRange(hsv, lowerOrange, upperOrange, mask);
+float circularityOf(double area, double spread) {
+    return static_cast<float>(area * area / (2.0 * CV_PI * spread));
+}
 
-    // Clean up the mask to remove noise
-    Mat kernel = getStructuringElement(MORPH_ELLIPSE, Size(5, 5));
-    morphologyEx(mask, mask, MORPH_OPEN, kernel);
+} // namespace
+
+void BallDetector::findBalls(const Mat& region, const Point2f& offset, vector<Ball>& balls) {
+    // One table lookup per pixel replaces cvtColor(BGR2HSV) + inRange
+    lut.classify(region, mask);
+
+    // Join blobs split by a seam and fill small highlights
     morphologyEx(mask, mask, MORPH_CLOSE, kernel);
 
-    vector<vector<Point>> contours;
-    findContours(mask, contours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+    const vector<BlobStats>& blobs = labeler.label(mask);
+    for (int index = 0; index < int(blobs.size()); ++index) {
+        const BlobStats& blob = blobs[index];
+        // Filter out small, noisy blobs (this also replaces the old morphological opening)
+        if (blob.area <= minArea) continue;
 
-    vector<Ball> balls;
-    for (const auto& contour : contours) {
-        float area = contourArea(contour);
-        // Filter out small, noisy contours
-        if (area > 100) {
-            Point2f center;
-            float radius;
-            minEnclosingCircle(contour, center, radius);
-
-            // Check if the contour is reasonably circular
-            float circularity = area / (CV_PI * radius * radius);
-            if (circularity > 0.6) {
-                balls.push_back({center, radius});
-            }
+        double area = blob.area;
+        double spread = blob.mu20 + blob.mu02;
+        Point2f centroid = blob.centroid;
+        if (spread <= 0) continue;
+
+        // A disc of radius R with a hole of radius a scores (R^2 - a^2) / (R^2 + a^2),
+        // so a highlight larger than the closing can reject a real ball
+        if (circularityOf(area, spread) <= minCircularity &&
+            (!fillHoles(index, blob, area, spread, centroid) || circularityOf(area, spread) <= minCircularity)) {
+            continue;
         }
+        balls.push_back({centroid + offset, radiusOf(area, spread)});
     }
-    return balls;
-}
\ No newline at end of file
+}
+
+bool BallDetector::fillHoles(int index, const BlobStats& blob, double& area, double& spread, Point2f& centroid) {
+    // Draw only this blob (not its neighbours in the mask) into its box with a
+    // clear border, and fill the background from outside; whatever background
+    // is left is enclosed by the blob
+    const Rect& box = blob.bbox;
+    filled.create(box.height + 2, box.width + 2, CV_8UC1);
+    filled.setTo(Scalar(0));
+    labeler.drawBlob(index, filled, Point(box.x - 1, box.y - 1));
+    Mat inner = filled(Rect(1, 1, box.width, box.height));
+    floodFill(filled, Point(0, 0), Scalar(128));
+
+    // Raw moments of the holes, in mask coordinates
+    double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m02 = 0;
+    for (int y = 0; y < box.height; ++y) {
+        const uint8_t* row = inner.ptr<uint8_t>(y);
+        double py = box.y + y;
+        for (int x = 0; x < box.width; ++x) {
+            if (row[x] != 0) continue;
+            double px = box.x + x;
+            m00 += 1;
+            m10 += px;
+            m01 += py;
+            m20 += px * px;
+            m02 += py * py;
+        }
+    }
+    if (m00 == 0) return false;
+
+    // Combine blob and holes about their joint centroid (parallel axis theorem)
+    Point2d hole(m10 / m00, m01 / m00);
+    double hole_spread = (m20 - m00 * hole.x * hole.x) + (m02 - m00 * hole.y * hole.y);
+    double total = area + m00;
+    Point2d joint((area * centroid.x + m00 * hole.x) / total, (area * centroid.y + m00 * hole.y) / total);
+    auto shift = [&](const Point2d& c) { return (c.x - joint.x) * (c.x - joint.x) + (c.y - joint.y) * (c.y - joint.y); };
+    spread = spread + area * shift(Point2d(centroid.x, centroid.y)) + hole_spread + m00 * shift(hole);
+    area = total;
+    centroid = Point2f(float(joint.x), float(joint.y));
+    return true;
+}
@@ -1,146 +1,292 @@
 #include "ai_handler.h"
+#include "mlp_policy.h"
+#include "ort_policy.h"
 #include <iostream>
 #include <vector>
-#include <cmath>
 #include <algorithm>
-#include <limits>
-#include <iomanip> // For std::fixed and std::setprecision
-
-// --- CONFIGURATION CONSTANTS (Unchanged) ---
-constexpr int ARENA_WIDTH = 480;
-constexpr int ARENA_HEIGHT = 480;
-constexpr int OBSERVATION_SIZE = 22;
-const cv::Point2f OPPONENT_GOAL_POSITION(ARENA_WIDTH / 2.0f, 0.0f);
-
-AIHandler::AIHandler(const std::string& model_path)
-    : env(ORT_LOGGING_LEVEL_WARNING, "RobotSoccerAI"),
-      session(env, model_path.c_str(), Ort::SessionOptions{nullptr}) {
-    std::cout << "[AI] ONNX model loaded successfully from: " << model_path << std::endl;
-}
+#include <array>
+#include <chrono>
+#include <cmath>
 
-std::vector<float> AIHandler::createObservationVector(const Bot& current_bot, const WorldState& world) {
-    // This function's logic is unchanged.
-    std::vector<float> obs(OBSERVATION_SIZE, 0.0f);
-
-    obs[0] = current_bot.center.x / ARENA_WIDTH;
-    obs[1] = current_bot.center.y / ARENA_HEIGHT;
-    float angle_rad = current_bot.angle * CV_PI / 180.0;
-    obs[2] = std::cos(angle_rad);
-    obs[3] = std::sin(angle_rad);
-
-    const Bot* teammate = nullptr;
-    float min_teammate_dist = std::numeric_limits<float>::max();
-    for (const auto& other_bot : world.bots) {
-        if (other_bot.id == current_bot.id) continue;
-        float dist = cv::norm(current_bot.center - other_bot.center);
-        if (dist < min_teammate_dist) {
-            min_teammate_dist = dist;
-            teammate = &other_bot;
+std::unique_ptr<PolicyBackend> AIHandler::createPolicy(const AIConfig& config) {
+    bool int8 = config.precision == "int8";
+    if (!int8 && config.precision != "fp32") {
+        std::cerr << "[AI] Unknown precision '" << config.precision << "', using 'fp32'." << std::endl;
+    }
+    if (config.backend == "mlp") {
+        auto mlp = std::make_unique<MlpPolicy>(config.deterministic, int8 ? MlpPolicy::Precision::INT8 : MlpPolicy::Precision::FP32);
+        if (mlp->load(config.modelPath)) {
+            std::cout << "[AI] Using the built-in " << mlp->name() << " engine for " << config.modelPath << "." << std::endl;
+            return mlp;
         }
+        std::cerr << "[AI] Falling back to ONNX Runtime." << std::endl;
+    } else if (config.backend != "onnxruntime") {
+        std::cerr << "[AI] Unknown backend '" << config.backend << "', using 'onnxruntime'." << std::endl;
     }
+    if (int8) {
+        std::cerr << "[AI] precision 'int8' needs the 'mlp' backend; ONNX Runtime runs " << config.modelPath << " as is." << std::endl;
+    }
+    return std::make_unique<OrtPolicy>(config, MAX_BOTS);
+}
 
-    if (teammate) {
-        cv::Point2f dir_to_teammate = teammate->center - current_bot.center;
-        float dist_to_teammate = cv::norm(dir_to_teammate);
-        obs[4] = dist_to_teammate / ARENA_WIDTH;
-        if (dist_to_teammate > 1e-6) {
-            obs[5] = dir_to_teammate.x / dist_to_teammate;
-            obs[6] = dir_to_teammate.y / dist_to_teammate;
-        }
+void AIHandler::warmUp(PolicyBackend& backend) {
+    // Runs every batch size once, so lazily built state (e.g. ORT bindings)
+    // exists before the backend handles its first real step
+    std::vector<float> obs(MAX_BOTS * OBSERVATION_SIZE, 0.0f), actions(MAX_BOTS * ACTION_SIZE);
+    for (int batch = 1; batch <= MAX_BOTS; ++batch) {
+        backend.run(obs.data(), batch, actions.data());
     }
+}
+
+void PolicyLatency::add(double ms) {
+    recent.add(float(ms));
+    ++runs;
+    total_ms += ms;
+    max_ms = std::max(max_ms, ms);
+}
 
-    cv::Point2f dir_to_goal = OPPONENT_GOAL_POSITION - current_bot.center;
-    float dist_to_goal = cv::norm(dir_to_goal);
-    obs[7] = dist_to_goal / ARENA_WIDTH;
-    if (dist_to_goal > 1e-6) {
-        obs[8] = dir_to_goal.x / dist_to_goal;
-        obs[9] = dir_to_goal.y / dist_to_goal;
-    }
-
-    std::vector<Ball> sorted_balls = world.balls;
-    std::sort(sorted_balls.begin(), sorted_balls.end(), [&](const Ball& a, const Ball& b) {
-        return cv::norm(a.center - current_bot.center) < cv::norm(b.center - current_bot.center);
-    });
-
-    for (int i = 0; i < 4; ++i) {
-        int base_idx = 10 + i * 3;
-        if (i < sorted_balls.size()) {
-            const Ball& ball = sorted_balls[i];
-            cv::Point2f dir_to_ball = ball.center - current_bot.center;
-            float dist_to_ball = cv::norm(dir_to_ball);
-            obs[base_idx] = dist_to_ball / ARENA_WIDTH;
-            if (dist_to_ball > 1e-6) {
-                obs[base_idx + 1] = dir_to_ball.x / dist_to_ball;
-                obs[base_idx + 2] = dir_to_ball.y / dist_to_ball;
+AIHandler::AIHandler(const AIConfig& config)
+    : obs_buffer(MAX_BOTS * OBSERVATION_SIZE, 0.0f),
+      action_buffer(MAX_BOTS * ACTION_SIZE, 0.0f),
+      change_epsilon(config.changeEpsilon) {
+    std::vector<PolicyConfig> policies = config.policies;
+    if (policies.empty()) {
+        PolicyConfig all;
+        all.modelPath = config.modelPath;
+        policies.push_back(all);
+    }
+
+    // A bot listed by a policy belongs to it; the rest go to the first policy without a list
+    slot_of_id.fill(-1);
+    for (size_t s = policies.size(); s-- > 0;) {
+        if (policies[s].botIds.empty()) {
+            slot_of_id.fill(int(s));
+        }
+    }
+    for (size_t s = 0; s < policies.size(); ++s) {
+        for (int id : policies[s].botIds) {
+            if (id < 0 || id >= MAX_BOTS) {
+                std::cerr << "[AI] Bot ID " << id << " of team " << policies[s].team << " is out of range." << std::endl;
+            } else {
+                slot_of_id[id] = int(s);
             }
         }
     }
 
-    return obs;
-}
+    slots.resize(policies.size());
+    for (size_t s = 0; s < policies.size(); ++s) {
+        PolicySlot& slot = slots[s];
+        slot.config = policies[s];
+        AIConfig slot_config = config;
+        slot_config.modelPath = slot.config.modelPath;
+        slot.backend = createPolicy(slot_config);
+        warmUp(*slot.backend);
+        // Reloads bypass the optimized-model cache: slots sharing a model would
+        // write it at the same time, and the next start rebuilds it anyway
+        AIConfig reload_config = slot_config;
+        reload_config.cacheOptimizedModel = false;
+        slot.reloader = std::make_unique<PolicyReloader>(
+                [reload_config] {
+                    auto backend = createPolicy(reload_config);
+                    warmUp(*backend);
+                    return backend;
+                },
+                config.watchModel ? slot_config.modelPath : std::string());
+        slot.batch.reserve(MAX_BOTS);
+        slot.batch_obs.resize(MAX_BOTS * OBSERVATION_SIZE);
+        slot.batch_actions.resize(MAX_BOTS * ACTION_SIZE);
+        if (policies.size() > 1) {
+            std::cout << "[AI] Team " << slot.config.team << " uses " << slot.config.modelPath << "." << std::endl;
+        }
+    }
 
-std::map<int, MovementCommand> AIHandler::predictMovements(const WorldState& world) {
-    std::map<int, MovementCommand> commands;
-    if (world.bots.empty()) {
-        return commands;
+    commands.reserve(MAX_BOTS);
+    driven.reserve(MAX_BOTS);
+    bot_teams.reserve(MAX_BOTS);
+    bot_goals.reserve(MAX_BOTS);
+    last_ids.reserve(MAX_BOTS);
+    last_obs.reserve(MAX_BOTS * OBSERVATION_SIZE);
+    last_commands.reserve(MAX_BOTS);
+    if (!config.recordPath.empty()) {
+        world_log.open(config.recordPath, std::ios::app);
+        if (!world_log) std::cerr << "[AI] Cannot open " << config.recordPath << " for recording." << std::endl;
+    }
+    trace_ring.setLevel(config.traceLevel);
+    if (!config.tracePath.empty() && config.traceCapacity > 0) {
+        trace_ring.open(config.tracePath, uint32_t(config.traceCapacity));
     }
+}
 
-    std::vector<float> obs_0_data;
-    std::vector<float> action_masks_data;
-    std::vector<const Bot*> bot_order;
+void AIHandler::reloadModel() {
+    for (PolicySlot& slot : slots) {
+        slot.reloader->request();
+    }
+}
 
-    for (const auto& bot : world.bots) {
-        std::vector<float> single_obs = createObservationVector(bot, world);
-        obs_0_data.insert(obs_0_data.end(), single_obs.begin(), single_obs.end());
-        action_masks_data.push_back(1.0f);
-        bot_order.push_back(&bot);
+void AIHandler::printLatencyStats() const {
+    for (const PolicySlot& slot : slots) {
+        const PolicyLatency& latency = slot.latency;
+        if (latency.runs == 0) continue;
+        std::cout << "[AI] Team " << slot.config.team << " (" << slot.backend->name() << "): " << latency.runs
+                  << " runs, mean " << latency.total_ms / latency.runs << " ms, p50 " << latency.percentile(0.5)
+                  << " ms, p99 " << latency.percentile(0.99) << " ms, max " << latency.max_ms << " ms" << std::endl;
+    }
+}
 
-        // --- DEBUGGING PRINT STATEMENTS ADDED HERE ---
-        std::cout << "\n--- AI DEBUG (Bot ID: " << bot.id << ") ---" << std::endl;
-        std::cout << std::fixed << std::setprecision(3);
-        std::cout << "INPUT - Self State:  pos(x:" << single_obs[0] << ", z:" << single_obs[1] << "), dir(x:" << single_obs[2] << ", z:" << single_obs[3] << ")" << std::endl;
-        std::cout << "INPUT - Teammate:    dist:" << single_obs[4] << ", dir(x:" << single_obs[5] << ", z:" << single_obs[6] << ")" << std::endl;
-        std::cout << "INPUT - Goal:        dist:" << single_obs[7] << ", dir(x:" << single_obs[8] << ", z:" << single_obs[9] << ")" << std::endl;
-        std::cout << "INPUT - Ball 1:      dist:" << single_obs[10] << ", dir(x:" << single_obs[11] << ", z:" << single_obs[12] << ")" << std::endl;
-        std::cout << "INPUT - Ball 2:      dist:" << single_obs[13] << ", dir(x:" << single_obs[14] << ", z:" << single_obs[15] << ")" << std::endl;
+void AIHandler::writeTrace(const WorldState& world, uint64_t timestamp_ns) {
+    int level = trace_ring.level();
+    TraceRecord record;
+    record.timestamp_ns = timestamp_ns;
+    record.call = call_count;
+    for (size_t c = 0; c < driven.size(); ++c) {
+        int i = driven[c];
+        record.bot_id = world.bots[i].id;
+        std::copy_n(obs_buffer.data() + i * OBSERVATION_SIZE, OBSERVATION_SIZE, record.observation);
+        std::copy_n(action_buffer.data() + i * ACTION_SIZE, ACTION_SIZE, record.action);
+        record.left = commands[c].cmd.left;
+        record.right = commands[c].cmd.right;
+        trace_ring.write(record);
+        if (level >= TraceRing::PRINT) {
+            printTraceRecord(std::cout, record);
+        }
+    }
+    if (level >= TraceRing::PRINT) {
+        std::cout.flush();
     }
+}
 
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+bool AIHandler::unchangedSinceLastRun(const WorldState& world, int bot_count) const {
+    if (change_epsilon <= 0.0f || int(last_ids.size()) != bot_count) {
+        return false;
+    }
+    // Same bots in the same order, so the cached commands line up
+    for (int i = 0; i < bot_count; ++i) {
+        if (last_ids[i] != world.bots[i].id) return false;
+    }
+    for (int i = 0; i < bot_count * OBSERVATION_SIZE; ++i) {
+        if (std::abs(obs_buffer[i] - last_obs[i]) > change_epsilon) return false;
+    }
+    return true;
+}
 
-    std::vector<int64_t> obs_0_shape = {static_cast<int64_t>(world.bots.size()), OBSERVATION_SIZE};
-    Ort::Value obs_0_tensor = Ort::Value::CreateTensor<float>(memory_info, obs_0_data.data(), obs_0_data.size(), obs_0_shape.data(), obs_0_shape.size());
+const std::vector<BotCommand>& AIHandler::predictMovements(const WorldState& world) {
+    commands.clear();
+    if (world.bots.empty()) {
+        return commands;
+    }
+    if (world_log.is_open()) {
+        world_log << json(world).dump() << '\n';
+    }
 
-    std::vector<int64_t> action_masks_shape = {static_cast<int64_t>(world.bots.size()), 1};
-    Ort::Value action_masks_tensor = Ort::Value::CreateTensor<float>(memory_info, action_masks_data.data(), action_masks_data.size(), action_masks_shape.data(), action_masks_shape.size());
+    int bot_count = static_cast<int>(world.bots.size());
+    if (bot_count > MAX_BOTS) {
+        std::cerr << "[AI] " << bot_count << " bots in world state, only the first " << MAX_BOTS << " are driven." << std::endl;
+        bot_count = MAX_BOTS;
+    }
 
-    const char* input_names[] = {"obs_0", "action_masks"};
-    const char* output_names[] = {"continuous_actions"};
+    // Switch to reloaded models between steps; the old ones are destroyed off this thread
+    for (PolicySlot& slot : slots) {
+        if (auto next = slot.reloader->takeReady()) {
+            slot.reloader->retire(std::move(slot.backend));
+            slot.backend = std::move(next);
+            last_ids.clear(); // The change gate must not reuse the old model's commands
+            std::cout << "[AI] Switched team " << slot.config.team << " to the reloaded " << slot.backend->name() << " policy." << std::endl;
+        }
+    }
 
-    std::vector<Ort::Value> input_tensors;
-    input_tensors.push_back(std::move(obs_0_tensor));
-    input_tensors.push_back(std::move(action_masks_tensor));
+    auto started = std::chrono::steady_clock::now();
+    ++call_count;
 
-    try {
-        auto output_tensors = session.Run(Ort::RunOptions{nullptr}, input_names, input_tensors.data(), input_tensors.size(), output_names, 1);
-        const float* actions_data = output_tensors[0].GetTensorData<float>();
+    // Assign every bot to its policy's batch
+    for (PolicySlot& slot : slots) {
+        slot.batch.clear();
+    }
+    bot_teams.resize(world.bots.size());
+    bot_goals.resize(world.bots.size());
+    for (size_t i = 0; i < world.bots.size(); ++i) {
+        int s = slotOf(world.bots[i].id);
+        bot_teams[i] = s;
+        bot_goals[i] = s >= 0 ? slots[s].config.opponentGoal : OPPONENT_GOAL_POSITION;
+        if (s >= 0 && int(i) < bot_count) {
+            slots[s].batch.push_back(int(i));
+        }
+    }
+    bool several_teams = slots.size() > 1;
+    observations.build(world, bot_count, obs_buffer.data(),
+                       several_teams ? bot_teams.data() : nullptr, several_teams ? bot_goals.data() : nullptr);
 
-        for (size_t i = 0; i < bot_order.size(); ++i) {
-            int bot_id = bot_order[i]->id;
-            float forward_cmd = actions_data[i * 2];
-            float steer_cmd = actions_data[i * 2 + 1];
+    if (++gate_stats.calls % STATS_REPORT_STEPS == 0) {
+        std::cout << "[AI] Change gate reused " << gate_stats.reused << " of " << gate_stats.calls << " steps ("
+                  << 100 * gate_stats.reused / gate_stats.calls << "%), saving ~" << int(gate_stats.saved_ms) << " ms" << std::endl;
+        printLatencyStats();
+    }
+    if (unchangedSinceLastRun(world, bot_count)) {
+        ++gate_stats.reused;
+        gate_stats.saved_ms += gate_stats.run_ms;
+        commands = last_commands;
+        return commands;
+    }
+    auto run_started = std::chrono::steady_clock::now();
+    std::array<bool, MAX_BOTS> ran{};
 
-            // --- DEBUGGING PRINT STATEMENT ADDED HERE ---
-            std::cout << "OUTPUT - AI Action:  forward:" << forward_cmd << ", steer:" << steer_cmd << std::endl;
+    // One batched run per model: gather its bots' rows, run, scatter the actions back
+    for (PolicySlot& slot : slots) {
+        int batch = int(slot.batch.size());
+        if (batch == 0) continue;
+        for (int b = 0; b < batch; ++b) {
+            std::copy_n(obs_buffer.data() + slot.batch[b] * OBSERVATION_SIZE, OBSERVATION_SIZE,
+                        slot.batch_obs.data() + b * OBSERVATION_SIZE);
+        }
+        try {
+            auto slot_started = std::chrono::steady_clock::now();
+            slot.backend->run(slot.batch_obs.data(), batch, slot.batch_actions.data());
+            slot.latency.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - slot_started).count());
+        } catch (const std::exception& e) {
+            std::cerr << "[AI] Team " << slot.config.team << " " << slot.backend->name() << " inference error: " << e.what() << std::endl;
+            continue; // Its bots get no command this step
+        }
+        for (int b = 0; b < batch; ++b) {
+            std::copy_n(slot.batch_actions.data() + b * ACTION_SIZE, ACTION_SIZE,
+                        action_buffer.data() + slot.batch[b] * ACTION_SIZE);
+            ran[slot.batch[b]] = true;
+        }
+    }
 
-            float left_motor = forward_cmd - steer_cmd;
-            float right_motor = forward_cmd + steer_cmd;
-            left_motor = std::clamp(left_motor, -1.0f, 1.0f);
-            right_motor = std::clamp(right_motor, -1.0f, 1.0f);
-            commands[bot_id] = {left_motor, right_motor};
+    // Commands in world order
+    driven.clear();
+    bool complete = true;
+    for (int i = 0; i < bot_count; ++i) {
+        if (!ran[i]) {
+            complete &= bot_teams[i] < 0; // Unassigned, or its policy failed
+            continue;
         }
-    } catch (const Ort::Exception& e) {
-        std::cerr << "ONNX Runtime inference error: " << e.what() << std::endl;
+        int bot_id = world.bots[i].id;
+        float forward_cmd = action_buffer[i * 2];
+        float steer_cmd = action_buffer[i * 2 + 1];
+
+        float left_motor = forward_cmd - steer_cmd;
+        float right_motor = forward_cmd + steer_cmd;
+        left_motor = std::clamp(left_motor, -1.0f, 1.0f);
+        right_motor = std::clamp(right_motor, -1.0f, 1.0f);
+        commands.push_back({bot_id, {left_motor, right_motor}});
+        driven.push_back(i);
+    }
+    auto finished = std::chrono::steady_clock::now();
+    if (trace_ring.level() > TraceRing::OFF) {
+        writeTrace(world, std::chrono::duration_cast<std::chrono::nanoseconds>(started.time_since_epoch()).count());
+    }
+
+    // Remember this step for the change gate, unless a policy failed
+    if (complete) {
+        double run_ms = std::chrono::duration<double, std::milli>(finished - run_started).count();
+        gate_stats.run_ms = gate_stats.run_ms > 0.0 ? 0.9 * gate_stats.run_ms + 0.1 * run_ms : run_ms;
+        last_ids.clear();
+        for (int i = 0; i < bot_count; ++i) last_ids.push_back(world.bots[i].id);
+        last_obs.assign(obs_buffer.begin(), obs_buffer.begin() + bot_count * OBSERVATION_SIZE);
+        last_commands = commands;
+    } else {
+        last_ids.clear();
     }
 
     return commands;
-}
\ No newline at end of file
+}
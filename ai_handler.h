@@ -1,34 +1,118 @@
 #ifndef CAM_ARUCO_AI_HANDLER_H
 #define CAM_ARUCO_AI_HANDLER_H
 
-#include <map>
+#include <array>
+#include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
-#include <onnxruntime_cxx_api.h>
+#include "bot_command.h"
+#include "observation_builder.h"
+#include "pipeline_config.h"
+#include "policy_backend.h"
+#include "policy_reloader.h"
+#include "rolling_window.h"
+#include "trace_ring.h"
 #include "world_state.h"
 
-// This struct defines the output of our AI model
-struct MovementCommand {
-    float left;
-    float right;
+// How often the change gate let AIHandler reuse the previous commands
+struct ChangeGateStats {
+    uint64_t calls = 0;     // predictMovements calls with bots
+    uint64_t reused = 0;    // ... answered from the previous commands
+    double saved_ms = 0.0;  // Estimated inference time not spent, from the running average below
+    double run_ms = 0.0;    // Running average of the inference it replaces
+};
+
+// Rolling latency of one policy's inference calls
+struct PolicyLatency {
+    static constexpr int WINDOW = 512;
+    uint64_t runs = 0;
+    double total_ms = 0.0;
+    double max_ms = 0.0;
+    RollingWindow<WINDOW> recent; // The last WINDOW calls, for percentiles
+
+    void add(double ms);
+    double percentile(double p) const { return recent.percentile(p); }
 };
 
 class AIHandler {
 public:
-    // Constructor takes the path to the .onnx model file
-    AIHandler(const std::string& model_path);
+    // Bot markers use IDs 0-45, so there can never be more bots than this
+    static constexpr int MAX_BOTS = 46;
+
+    // Loads every configured policy (or just config.modelPath) into the
+    // configured backend. The built-in "mlp" backend falls back to ONNX
+    // Runtime if it can't read a model.
+    AIHandler(const AIConfig& config);
+
+    // Takes the current state of the world and returns movement commands, one
+    // per bot with a policy, in world order. The returned reference is
+    // valid until the next call. Bots sharing a policy are run as one batch.
+    // Observations and actions live in fixed buffers, so steady-state calls
+    // do not allocate. If nothing moved since the last call (see
+    // AIConfig::changeEpsilon) the previous commands are returned without
+    // running the policies.
+    const std::vector<BotCommand>& predictMovements(const WorldState& world);
+
+    const ChangeGateStats& changeGateStats() const { return gate_stats; }
+
+    // True if a policy drives this bot ID. Assignments are fixed at
+    // construction, so this is safe to call from any thread.
+    bool drives(int bot_id) const { return slotOf(bot_id) >= 0; }
 
-    // Takes the current state of the world and returns movement commands
-    std::map<int, MovementCommand> predictMovements(const WorldState& world);
+    // Reloads every policy's model in the background and switches to them
+    // between two steps; the current ones keep running meanwhile. Model files
+    // are also watched when config.watchModel is set. Safe to call from any thread.
+    void reloadModel();
+
+    // Prints each policy's call count and latency percentiles
+    void printLatencyStats() const;
+
+    // Observation/action trace of every step; its level can be changed from any thread
+    TraceRing& trace() { return trace_ring; }
 
 private:
-    // ONNX Runtime member variables
-    Ort::Env env;
-    Ort::Session session;
-    Ort::AllocatorWithDefaultOptions allocator;
+    // One model and the bots it drives
+    struct PolicySlot {
+        PolicyConfig config;
+        std::unique_ptr<PolicyBackend> backend;
+        std::unique_ptr<PolicyReloader> reloader;
+        std::vector<int> batch;        // World indices of this step's bots
+        std::vector<float> batch_obs;  // [MAX_BOTS x OBSERVATION_SIZE], gathered
+        std::vector<float> batch_actions;
+        PolicyLatency latency;
+    };
+    std::vector<PolicySlot> slots;
+    std::array<int, MAX_BOTS> slot_of_id; // Policy driving each bot ID, -1 for none
+
+    // Fixed-capacity tensor storage in world order, sized for MAX_BOTS
+    std::vector<float> obs_buffer;     // [MAX_BOTS x OBSERVATION_SIZE]
+    std::vector<float> action_buffer;  // [MAX_BOTS x ACTION_SIZE]
+    // Per world bot, including any beyond MAX_BOTS the builder searches as neighbours
+    std::vector<int> bot_teams;         // Slot of each world bot, for the observation builder
+    std::vector<cv::Point2f> bot_goals; // Goal each world bot attacks
+    std::vector<int> driven;            // World index of each command
+
+    ObservationBuilder observations;
+    std::vector<BotCommand> commands;
+
+    // Change gate: the inputs and result of the last inference
+    float change_epsilon;
+    std::vector<int> last_ids;
+    std::vector<float> last_obs;
+    std::vector<BotCommand> last_commands;
+    ChangeGateStats gate_stats;
+
+    std::ofstream world_log; // Open when config.recordPath is set
+    TraceRing trace_ring;
+    uint32_t call_count = 0;
+
+    void writeTrace(const WorldState& world, uint64_t timestamp_ns);
+    bool unchangedSinceLastRun(const WorldState& world, int bot_count) const;
+    int slotOf(int bot_id) const { return bot_id >= 0 && bot_id < MAX_BOTS ? slot_of_id[bot_id] : -1; }
 
-    // Helper function to create the 22-feature observation vector for a single bot
-    std::vector<float> createObservationVector(const Bot& current_bot, const WorldState& world);
+    static std::unique_ptr<PolicyBackend> createPolicy(const AIConfig& config);
+    static void warmUp(PolicyBackend& backend);
 };
 
-#endif //CAM_ARUCO_AI_HANDLER_H
\ No newline at end of file
+#endif //CAM_ARUCO_AI_HANDLER_H
@@ -2,9 +2,43 @@
 #define CAM_ARUCO_ARENA_DETECTOR_H
 
 #include <opencv2/opencv.hpp>
+#include <vector>
 #include "ball_detector.h" // Include for Ball struct
+#include "marker_detector.h"
+#include "pipeline_config.h"
 
-// UPDATED FUNCTION SIGNATURE
-cv::Mat detectArenaMarkers(const cv::Mat& frame, cv::Mat& displayFrame, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, float markerLength, const std::vector<Ball>& balls);
+// Turns the arena corner markers (IDs 46-49) into the camera -> top-down homography.
+//
+// In lock mode the homography is estimated from the per-corner median of the
+// first lockFrames complete sightings and then frozen, so occluding a corner no
+// longer loses it. While locked, arena markers are only needed every
+// verifyInterval frames (see needsMarkers()); if a visible corner has drifted
+// more than maxDriftPx from its locked position, the lock is dropped and
+// re-estimated.
+class ArenaDetector {
+public:
+    explicit ArenaDetector(const ArenaConfig& config);
 
-#endif //CAM_ARUCO_ARENA_DETECTOR_H
\ No newline at end of file
+    // Takes the arena markers from this frame's shared detection pass and
+    // returns the current homography, or an empty Mat if it is not known.
+    cv::Mat update(const MarkerDetections& markers, cv::Mat& displayFrame, const std::vector<Ball>& balls);
+
+    bool isLocked() const { return locked; }
+
+    // True if the marker front-end should look for arena markers this frame.
+    bool needsMarkers() const;
+
+    // Drops the lock and re-estimates from the next frames.
+    void unlock();
+
+private:
+    ArenaConfig config;
+
+    bool locked = false;
+    cv::Mat lockedH;
+    std::vector<cv::Point2f> lockedCenters; // Image positions of markers 46-49
+    std::vector<std::vector<cv::Point2f>> samples; // Per corner, while estimating
+    int framesSinceCheck = 0;
+};
+
+#endif //CAM_ARUCO_ARENA_DETECTOR_H
@@ -0,0 +1,11 @@
+#ifndef CAM_ARUCO_ARENA_GEOMETRY_H
+#define CAM_ARUCO_ARENA_GEOMETRY_H
+
+#include <opencv2/core.hpp>
+
+// --- ARENA GEOMETRY (top-down view, in pixels) ---
+constexpr int ARENA_WIDTH = 480;
+constexpr int ARENA_HEIGHT = 480;
+const cv::Point2f OPPONENT_GOAL_POSITION(ARENA_WIDTH / 2.0f, 0.0f);
+
+#endif //CAM_ARUCO_ARENA_GEOMETRY_H
@@ -3,14 +3,45 @@
 
 #include <opencv2/opencv.hpp>
 #include <vector>
+#include "blob_labeler.h"
+#include "color_lut.h"
+#include "pipeline_config.h"
 
 
 struct Ball {
     cv::Point2f center;
     float radius;
-    int id;
+    int id = -1;          // Persistent track ID, -1 for raw detections
+    cv::Point2f velocity; // Per second, from the ball tracker
 };
 
-std::vector<Ball> detectOrangeBalls(const cv::Mat& frame);
+// Finds orange balls using a precomputed colour LUT. The LUT is loaded from
+// balls.lutPath (as exported by hsv_tuner) if present, otherwise it is built
+// from the configured HSV bounds at startup. The mask is closed, then blobs
+// are measured by a run-length labeler and kept if they are large and round
+// enough, with holes filled (as the outer contour did) when that decides it.
+class BallDetector {
+public:
+    explicit BallDetector(const BallConfig& config);
+
+    std::vector<Ball> detect(const cv::Mat& frame);
+
+    // Only searches the given (non-overlapping) windows of the frame.
+    std::vector<Ball> detect(const cv::Mat& frame, const std::vector<cv::Rect>& windows);
+
+private:
+    ColorLUT lut;
+    BlobLabeler labeler;
+    float minArea;
+    float minCircularity;
+    cv::Mat kernel;
+    cv::Mat mask;   // Reused across frames
+    cv::Mat filled; // Reused by fillHoles
+
+    void findBalls(const cv::Mat& region, const cv::Point2f& offset, std::vector<Ball>& balls);
+    // Adds the blob's enclosed background (e.g. a specular highlight) to its
+    // area, spread (mu20 + mu02) and centroid. Returns false if it has no holes.
+    bool fillHoles(int index, const BlobStats& blob, double& area, double& spread, cv::Point2f& centroid);
+};
 
 #endif // BALL_DETECTOR_H
@@ -0,0 +1,118 @@
+#include "ball_tracker.h"
+#include <algorithm>
+#include "rect_utils.h"
+
+using namespace cv;
+using namespace std;
+
+BallTracker::BallTracker(const BallTrackerConfig& config) : config(config) {}
+
+BallTracker::Track BallTracker::newTrack(const Ball& detection) {
+    Track track{nextId++, KalmanFilter(4, 2, 0, CV_32F), detection.radius, 1, 0};
+    KalmanFilter& kf = track.kf;
+
+    setIdentity(kf.measurementMatrix);
+    setIdentity(kf.measurementNoiseCov, Scalar::all(config.measurementNoise));
+    // Position is known from the first detection, velocity is not
+    setIdentity(kf.errorCovPost, Scalar::all(config.measurementNoise));
+    kf.errorCovPost.at<float>(2, 2) = kf.errorCovPost.at<float>(3, 3) = 1e4f;
+    kf.statePost.at<float>(0) = detection.center.x;
+    kf.statePost.at<float>(1) = detection.center.y;
+    return track;
+}
+
+Point2f BallTracker::predictedCenter(const Track& track, float dt) const {
+    const Mat& s = track.kf.statePost;
+    return Point2f(s.at<float>(0) + s.at<float>(2) * dt, s.at<float>(1) + s.at<float>(3) * dt);
+}
+
+bool BallTracker::needsFullScan() const {
+    return !config.tracking || tracks.empty() || rescanRequested || framesSinceFullScan >= config.fullScanInterval;
+}
+
+void BallTracker::searchWindows(Clock::time_point when, const Size& frameSize, vector<Rect>& windows) const {
+    float dt = chrono::duration<float>(when - lastUpdate).count();
+    const Rect frameRect(0, 0, frameSize.width, frameSize.height);
+
+    windows.clear();
+    for (const auto& track : tracks) {
+        Point2f center = predictedCenter(track, dt);
+        int half = cvRound(track.radius + config.searchMargin);
+        Rect window = Rect(cvRound(center.x) - half, cvRound(center.y) - half, 2 * half, 2 * half) & frameRect;
+        if (!window.empty()) windows.push_back(window);
+    }
+    mergeOverlappingRects(windows);
+}
+
+const vector<Ball>& BallTracker::update(const vector<Ball>& detections, Clock::time_point when, bool wasFullScan) {
+    float dt = tracks.empty() ? 0.0f : chrono::duration<float>(when - lastUpdate).count();
+    lastUpdate = when;
+    framesSinceFullScan = wasFullScan ? 0 : framesSinceFullScan + 1;
+
+    // --- Predict every track forward to this frame ---
+    for (auto& track : tracks) {
+        KalmanFilter& kf = track.kf;
+        kf.transitionMatrix.at<float>(0, 2) = dt;
+        kf.transitionMatrix.at<float>(1, 3) = dt;
+        setIdentity(kf.processNoiseCov, Scalar::all(config.processNoise * max(dt, 1e-3f)));
+        kf.predict();
+    }
+
+    // --- Greedy global nearest-neighbour association ---
+    candidates.clear();
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        const Mat& s = tracks[t].kf.statePost;
+        Point2f predicted(s.at<float>(0), s.at<float>(1));
+        for (size_t d = 0; d < detections.size(); ++d) {
+            float distance = static_cast<float>(norm(detections[d].center - predicted));
+            if (distance <= config.gateDistance) {
+                candidates.push_back({distance, {static_cast<int>(t), static_cast<int>(d)}});
+            }
+        }
+    }
+    sort(candidates.begin(), candidates.end());
+
+    trackMatched.assign(tracks.size(), false);
+    detectionMatched.assign(detections.size(), false);
+    Mat measurement(2, 1, CV_32F);
+    for (const auto& [distance, pair] : candidates) {
+        auto [t, d] = pair;
+        if (trackMatched[t] || detectionMatched[d]) continue;
+        trackMatched[t] = detectionMatched[d] = true;
+
+        Track& track = tracks[t];
+        measurement.at<float>(0) = detections[d].center.x;
+        measurement.at<float>(1) = detections[d].center.y;
+        track.kf.correct(measurement);
+        track.radius = detections[d].radius;
+        ++track.hits;
+        track.missedFrames = 0;
+    }
+
+    // --- Age unmatched tracks, drop lost ones, start new ones ---
+    rescanRequested = false;
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        if (!trackMatched[t]) {
+            ++tracks[t].missedFrames;
+            // Outside a full scan the ball may just have left its window
+            if (!wasFullScan) rescanRequested = true;
+        }
+    }
+    tracks.erase(remove_if(tracks.begin(), tracks.end(),
+                           [&](const Track& track) { return track.missedFrames > config.maxMissedFrames; }),
+                 tracks.end());
+    for (size_t d = 0; d < detections.size(); ++d) {
+        if (!detectionMatched[d]) tracks.push_back(newTrack(detections[d]));
+    }
+
+    // --- Report confirmed tracks; new IDs are larger, so this is ordered by ID ---
+    confirmed.clear();
+    for (const auto& track : tracks) {
+        if (track.hits < config.confirmFrames) continue;
+        const Mat& s = track.kf.statePost;
+        Ball ball{Point2f(s.at<float>(0), s.at<float>(1)), track.radius, track.id};
+        ball.velocity = Point2f(s.at<float>(2), s.at<float>(3));
+        confirmed.push_back(ball);
+    }
+    return confirmed;
+}
@@ -0,0 +1,60 @@
+#ifndef CAM_ARUCO_BALL_TRACKER_H
+#define CAM_ARUCO_BALL_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <vector>
+#include "ball_detector.h"
+#include "pipeline_config.h"
+
+// Gives detected balls persistent IDs across frames.
+// Each track runs a constant-velocity Kalman filter in image coordinates.
+// Detections are matched to predicted track positions greedily, closest pair
+// first, within gateDistance. Unmatched detections start new tracks, and
+// tracks coast on their prediction for up to maxMissedFrames.
+//
+// The predictions also drive windowed detection: between full scans, only
+// searchWindows() around the predicted balls need to be searched.
+class BallTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit BallTracker(const BallTrackerConfig& config);
+
+    // Advances all tracks to `when` and associates this frame's detections.
+    // Returns the confirmed balls ordered by ID, with velocities in px/s.
+    const std::vector<Ball>& update(const std::vector<Ball>& detections, Clock::time_point when, bool wasFullScan);
+
+    // True if the next frame should be searched in full: no tracks yet, the
+    // scan cadence is due, or a track went missing in its window.
+    bool needsFullScan() const;
+
+    // Padded, non-overlapping windows around every track's predicted position at `when`.
+    void searchWindows(Clock::time_point when, const cv::Size& frameSize, std::vector<cv::Rect>& windows) const;
+
+private:
+    struct Track {
+        int id;
+        cv::KalmanFilter kf; // State: x, y, vx, vy (px, px/s)
+        float radius;
+        int hits;
+        int missedFrames;
+    };
+
+    Track newTrack(const Ball& detection);
+    cv::Point2f predictedCenter(const Track& track, float dt) const;
+
+    BallTrackerConfig config;
+    std::vector<Track> tracks;
+    Clock::time_point lastUpdate;
+    int nextId = 0;
+    int framesSinceFullScan = 0;
+    bool rescanRequested = true;
+
+    // Scratch buffers, reused across frames
+    std::vector<std::pair<float, std::pair<int, int>>> candidates; // (distance, (track, detection))
+    std::vector<bool> trackMatched, detectionMatched;
+    std::vector<Ball> confirmed;
+};
+
+#endif //CAM_ARUCO_BALL_TRACKER_H
@@ -0,0 +1,129 @@
+#include "blob_labeler.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+constexpr int SUM_COUNT = 6;
+
+// Sum of k^2 for k = 0..n
+double sumOfSquares(double n) {
+    return n * (n + 1) * (2 * n + 1) / 6;
+}
+
+// Skips zero bytes eight at a time; masks are mostly background.
+int nextNonZero(const uint8_t* row, int x, int width) {
+    while (x + 8 <= width) {
+        uint64_t chunk;
+        memcpy(&chunk, row + x, sizeof(chunk));
+        if (chunk) break;
+        x += 8;
+    }
+    while (x < width && !row[x]) ++x;
+    return x;
+}
+
+} // namespace
+
+int BlobLabeler::findRoot(int i) {
+    while (runs[i].parent != i) {
+        runs[i].parent = runs[runs[i].parent].parent; // Path halving
+        i = runs[i].parent;
+    }
+    return i;
+}
+
+const vector<BlobStats>& BlobLabeler::label(const Mat& mask) {
+    CV_Assert(mask.type() == CV_8UC1);
+    runs.clear();
+    blobs.clear();
+
+    // --- Pass over the mask: encode runs and union them with the row above ---
+    size_t prevBegin = 0, prevEnd = 0;
+    for (int y = 0; y < mask.rows; ++y) {
+        const uint8_t* row = mask.ptr<uint8_t>(y);
+        size_t rowBegin = runs.size();
+        size_t p = prevBegin;
+
+        for (int x = nextNonZero(row, 0, mask.cols); x < mask.cols; x = nextNonZero(row, x, mask.cols)) {
+            int start = x;
+            while (x < mask.cols && row[x]) ++x;
+            int index = static_cast<int>(runs.size());
+            runs.push_back({y, start, x, index, -1});
+
+            // 8-connectivity: previous-row runs touching [start - 1, x] are joined
+            while (p < prevEnd && runs[p].end < start) ++p;
+            for (size_t q = p; q < prevEnd && runs[q].start <= x; ++q) {
+                int a = findRoot(index), b = findRoot(static_cast<int>(q));
+                if (a != b) runs[max(a, b)].parent = min(a, b);
+            }
+        }
+
+        prevBegin = rowBegin;
+        prevEnd = runs.size();
+    }
+
+    // --- Sum the raw moments of every run into its root ---
+    rootBlob.assign(runs.size(), -1);
+    sums.clear();
+    for (size_t i = 0; i < runs.size(); ++i) {
+        Run& run = runs[i];
+        int root = findRoot(static_cast<int>(i));
+        if (rootBlob[root] < 0) {
+            rootBlob[root] = static_cast<int>(blobs.size());
+            blobs.emplace_back();
+            blobs.back().bbox = Rect(run.start, run.y, 0, 0);
+            sums.insert(sums.end(), SUM_COUNT, 0.0);
+        }
+        int blob = rootBlob[root];
+        run.blob = blob;
+
+        double n = run.end - run.start;
+        double y = run.y;
+        double sx = n * (run.start + run.end - 1) / 2;
+        double sxx = sumOfSquares(run.end - 1) - sumOfSquares(run.start - 1);
+        double* s = &sums[blob * SUM_COUNT];
+        s[0] += n;
+        s[1] += sx;
+        s[2] += n * y;
+        s[3] += sxx;
+        s[4] += n * y * y;
+        s[5] += sx * y;
+
+        // bbox is tracked as inclusive corners here and converted below
+        Rect& box = blobs[blob].bbox;
+        box.x = min(box.x, run.start);
+        box.width = max(box.width, run.end - 1);
+        box.height = max(box.height, run.y);
+    }
+
+    // --- Turn raw moments into area, centroid and central moments ---
+    for (size_t b = 0; b < blobs.size(); ++b) {
+        const double* s = &sums[b * SUM_COUNT];
+        BlobStats& blob = blobs[b];
+        double cx = s[1] / s[0], cy = s[2] / s[0];
+        blob.area = static_cast<int>(s[0]);
+        blob.centroid = Point2f(static_cast<float>(cx), static_cast<float>(cy));
+        blob.mu20 = s[3] - cx * s[1];
+        blob.mu02 = s[4] - cy * s[2];
+        blob.mu11 = s[5] - cx * s[2];
+        blob.bbox.width = blob.bbox.width - blob.bbox.x + 1;
+        blob.bbox.height = blob.bbox.height - blob.bbox.y + 1;
+    }
+
+    return blobs;
+}
+
+void BlobLabeler::drawBlob(int blob, Mat& dst, const Point& origin) const {
+    // Runs are in row order, so the blob's start at its bbox's top row
+    const Rect& box = blobs[blob].bbox;
+    auto first = lower_bound(runs.begin(), runs.end(), box.y, [](const Run& run, int y) { return run.y < y; });
+    for (auto run = first; run != runs.end() && run->y < box.y + box.height; ++run) {
+        if (run->blob != blob) continue;
+        memset(dst.ptr<uint8_t>(run->y - origin.y) + (run->start - origin.x), 255, run->end - run->start);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef CAM_ARUCO_BLOB_LABELER_H
+#define CAM_ARUCO_BLOB_LABELER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// Shape statistics of one 8-connected foreground region.
+struct BlobStats {
+    int area = 0;          // Pixel count
+    cv::Point2f centroid;
+    cv::Rect bbox;
+    double mu20 = 0;       // Central second moments
+    double mu02 = 0;
+    double mu11 = 0;
+};
+
+// Single-pass connected-component labeler for binary masks.
+// Each row is run-length encoded, runs are joined to overlapping runs of the
+// previous row with union-find, and moments are summed per run in closed form,
+// so no label image or contour point lists are ever built. Cost follows the
+// number of foreground runs rather than the outline complexity.
+class BlobLabeler {
+public:
+    // Labels the non-zero pixels of a CV_8UC1 mask. The returned reference is
+    // valid until the next call.
+    const std::vector<BlobStats>& label(const cv::Mat& mask);
+
+    // Sets the pixels of blobs[blob] from the last label() call to 255 in
+    // dst, a CV_8UC1 image whose top-left pixel is origin in mask coordinates
+    // and which covers the blob's bbox. Other blobs are left out.
+    void drawBlob(int blob, cv::Mat& dst, const cv::Point& origin) const;
+
+private:
+    struct Run {
+        int y, start, end; // [start, end) on row y
+        int parent;
+        int blob;          // Index into blobs, set once runs are summed
+    };
+
+    int findRoot(int i);
+
+    // Scratch buffers, reused across frames
+    std::vector<Run> runs;
+    std::vector<int> rootBlob;
+    std::vector<double> sums; // m00, m10, m01, m20, m02, m11 per blob
+    std::vector<BlobStats> blobs;
+};
+
+#endif //CAM_ARUCO_BLOB_LABELER_H
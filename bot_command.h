@@ -0,0 +1,15 @@
+#ifndef CAM_ARUCO_BOT_COMMAND_H
+#define CAM_ARUCO_BOT_COMMAND_H
+
+// This struct defines the output of our AI model
+struct MovementCommand {
+    float left;
+    float right;
+};
+
+struct BotCommand {
+    int id;
+    MovementCommand cmd;
+};
+
+#endif //CAM_ARUCO_BOT_COMMAND_H
@@ -4,15 +4,15 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/aruco.hpp>
 #include <vector>
+#include "marker_detector.h"
 
 struct DetectedBot {
     int id;
     cv::Point2f center;
     float angleDeg;
-    bool isAI;
 };
 
-// UPDATED FUNCTION SIGNATURE
-std::vector<DetectedBot> detectBots(const cv::Mat& frame, cv::Mat& displayFrame, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, float markerLength);
+// Takes the bot markers (IDs < 46) from this frame's shared detection pass
+std::vector<DetectedBot> detectBots(const MarkerDetections& markers, cv::Mat& displayFrame, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, float markerLength);
 
 #endif //CAM_ARUCO_BOT_DETECTOR_H
\ No newline at end of file
@@ -1,29 +1,362 @@
 // camera_handler.cpp
-#include <opencv2/opencv.hpp>       // OpenCV core functionality
-#include <thread>                   // For multithreading
-#include <atomic>                   // For thread-safe boolean
-#include <mutex>                    // For thread-safe access to shared data
-
 #include "camera_handler.h"
-#include "json.hpp"
-using json = nlohmann::json;
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr unsigned int V4L2_BUFFER_COUNT = 6; // Triple buffer slots + one in flight + spares for the driver
+constexpr int GRAB_TIMEOUT_MS = 200;
+
+int xioctl(int fd, unsigned long request, void* arg) {
+    int result;
+    do {
+        result = ioctl(fd, request, arg);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+
+bool parsePixelFormat(const std::string& name, PixelFormat& format) {
+    if (name == "YUYV") { format = PixelFormat::YUYV; return true; }
+    if (name == "NV12") { format = PixelFormat::NV12; return true; }
+    if (name == "BGR3") { format = PixelFormat::BGR24; return true; }
+    return false;
+}
+
+uint32_t fourccOf(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::YUYV: return V4L2_PIX_FMT_YUYV;
+        case PixelFormat::NV12: return V4L2_PIX_FMT_NV12;
+        case PixelFormat::BGR24: return V4L2_PIX_FMT_BGR24;
+    }
+    return 0;
+}
+
+int matTypeOf(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::YUYV: return CV_8UC2;
+        case PixelFormat::NV12: return CV_8UC1;
+        case PixelFormat::BGR24: return CV_8UC3;
+    }
+    return CV_8UC3;
+}
+
+// Bytes per row of the first plane for a tightly packed frame.
+size_t packedStride(PixelFormat format, int width) {
+    switch (format) {
+        case PixelFormat::YUYV: return width * 2;
+        case PixelFormat::NV12: return width;
+        case PixelFormat::BGR24: return width * 3;
+    }
+    return width * 3;
+}
+
+// Rows of `stride` bytes in one frame. NV12 stores the UV plane below the Y plane.
+int matRowsOf(PixelFormat format, int height) {
+    return format == PixelFormat::NV12 ? height * 3 / 2 : height;
+}
+
+} // namespace
+
+struct CameraHandler::Impl {
+    struct Buffer {
+        void* start = MAP_FAILED;
+        size_t length = 0;
+    };
 
+    PixelFormat format = PixelFormat::YUYV;
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;
 
-std::atomic<bool> running(true);
-cv::Mat sharedFrame;
-std::mutex frameMutex;
+    // --- V4L2 device ---
+    int fd = -1;
+    std::atomic<bool> streaming{false};
+    std::vector<Buffer> buffers;
 
-void captureLoop(cv::VideoCapture& cap) {
-    cv::Mat local;
-    while (running) {
-        cap >> local;
-        if (local.empty()) continue;
+    // --- Raw file stand-in ---
+    void* fileData = MAP_FAILED;
+    size_t fileSize = 0;
+    size_t frameBytes = 0;
+    size_t frameCount = 0;
+    size_t nextFrame = 0;
+    std::chrono::steady_clock::duration framePeriod{};
+    std::chrono::steady_clock::time_point nextDue;
+
+    ~Impl() {
+        stopStreaming();
+        for (const auto& buffer : buffers) {
+            if (buffer.start != MAP_FAILED) munmap(buffer.start, buffer.length);
+        }
+        if (fileData != MAP_FAILED) munmap(fileData, fileSize);
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool isDevice() const { return !buffers.empty(); }
+
+    void stopStreaming() {
+        if (streaming.exchange(false)) {
+            v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            xioctl(fd, VIDIOC_STREAMOFF, &type);
+        }
+    }
+
+    // Hands a buffer back to the driver. Called from whichever thread drops
+    // the last lease on it; VIDIOC_QBUF is safe to issue concurrently with DQBUF.
+    void requeue(uint32_t index) {
+        if (!streaming) return;
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        if (xioctl(fd, VIDIOC_QBUF, &buf) == -1) {
+            std::cerr << "[Camera] VIDIOC_QBUF failed: " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    bool openDevice(const std::string& path, const CameraConfig& config) {
+        fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK);
+        if (fd < 0) {
+            std::cerr << "[Camera] Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        v4l2_capability cap{};
+        if (xioctl(fd, VIDIOC_QUERYCAP, &cap) == -1) {
+            std::cerr << "[Camera] " << path << " is not a V4L2 device." << std::endl;
+            return false;
+        }
+        uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+        if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+            std::cerr << "[Camera] " << path << " does not support streaming capture." << std::endl;
+            return false;
+        }
+
+        v4l2_format fmt{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = config.width;
+        fmt.fmt.pix.height = config.height;
+        fmt.fmt.pix.pixelformat = fourccOf(format);
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(fd, VIDIOC_S_FMT, &fmt) == -1 || fmt.fmt.pix.pixelformat != fourccOf(format)) {
+            std::cerr << "[Camera] " << path << " does not offer pixel format " << config.pixelFormat << std::endl;
+            return false;
+        }
+        width = fmt.fmt.pix.width;
+        height = fmt.fmt.pix.height;
+        stride = fmt.fmt.pix.bytesperline;
+
+        v4l2_requestbuffers req{};
+        req.count = V4L2_BUFFER_COUNT;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(fd, VIDIOC_REQBUFS, &req) == -1 || req.count < 4) {
+            std::cerr << "[Camera] Could not allocate enough mmap buffers on " << path << std::endl;
+            return false;
+        }
+
+        buffers.resize(req.count);
+        for (uint32_t i = 0; i < req.count; ++i) {
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (xioctl(fd, VIDIOC_QUERYBUF, &buf) == -1) {
+                std::cerr << "[Camera] VIDIOC_QUERYBUF failed: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            buffers[i].length = buf.length;
+            buffers[i].start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+            if (buffers[i].start == MAP_FAILED) {
+                std::cerr << "[Camera] mmap failed: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            if (xioctl(fd, VIDIOC_QBUF, &buf) == -1) {
+                std::cerr << "[Camera] VIDIOC_QBUF failed: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+        }
 
-        {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            local.copyTo(sharedFrame);
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(fd, VIDIOC_STREAMON, &type) == -1) {
+            std::cerr << "[Camera] VIDIOC_STREAMON failed: " << std::strerror(errno) << std::endl;
+            return false;
         }
+        streaming = true;
+
+        std::cout << "[Camera] Streaming " << width << "x" << height << " " << config.pixelFormat
+                  << " from " << path << " with " << buffers.size() << " mmap buffers." << std::endl;
+        return true;
+    }
+
+    bool openFile(const std::string& path, const CameraConfig& config) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st{};
+        if (fd < 0 || fstat(fd, &st) == -1) {
+            std::cerr << "[Camera] Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        width = config.width;
+        height = config.height;
+        stride = packedStride(format, width);
+        frameBytes = stride * matRowsOf(format, height);
+        fileSize = st.st_size;
+        frameCount = frameBytes > 0 ? fileSize / frameBytes : 0;
+        if (frameCount == 0) {
+            std::cerr << "[Camera] " << path << " holds no complete " << width << "x" << height
+                      << " " << config.pixelFormat << " frame." << std::endl;
+            return false;
+        }
+
+        // Private mapping: frames are copy-on-write, so nothing downstream can modify the file.
+        fileData = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (fileData == MAP_FAILED) {
+            std::cerr << "[Camera] mmap failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1.0 / std::max(config.fileFps, 1.0)));
+        nextDue = std::chrono::steady_clock::now();
+
+        std::cout << "[Camera] Playing " << frameCount << " raw " << config.pixelFormat
+                  << " frames from " << path << " (file stand-in)." << std::endl;
+        return true;
+    }
+
+    // Returns the buffer index of the next frame, or -1.
+    int dequeueDevice() {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, GRAB_TIMEOUT_MS) <= 0) return -1;
+
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(fd, VIDIOC_DQBUF, &buf) == -1) {
+            if (errno != EAGAIN) {
+                std::cerr << "[Camera] VIDIOC_DQBUF failed: " << std::strerror(errno) << std::endl;
+            }
+            return -1;
+        }
+        if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+            requeue(buf.index);
+            return -1;
+        }
+        return static_cast<int>(buf.index);
+    }
+
+    // Returns the start of the next file frame, paced to the configured rate.
+    uint8_t* nextFileFrame() {
+        std::this_thread::sleep_until(nextDue);
+        nextDue += framePeriod;
+        uint8_t* data = static_cast<uint8_t*>(fileData) + nextFrame * frameBytes;
+        nextFrame = (nextFrame + 1) % frameCount;
+        return data;
+    }
+};
+
+CameraHandler::CameraHandler() = default;
+
+CameraHandler::~CameraHandler() {
+    close();
+}
+
+bool CameraHandler::open(const CameraConfig& config) {
+    close();
+
+    auto next = std::make_shared<Impl>();
+    if (!parsePixelFormat(config.pixelFormat, next->format)) {
+        std::cerr << "[Camera] Unsupported pixel format '" << config.pixelFormat << "'." << std::endl;
+        return false;
+    }
+
+    struct stat st{};
+    if (stat(config.device.c_str(), &st) == -1) {
+        std::cerr << "[Camera] " << config.device << " does not exist." << std::endl;
+        return false;
+    }
+
+    bool opened = S_ISCHR(st.st_mode) ? next->openDevice(config.device, config)
+                                      : next->openFile(config.device, config);
+    if (!opened) return false;
+
+    impl = std::move(next);
+    return true;
+}
+
+bool CameraHandler::isOpened() const {
+    return impl != nullptr;
+}
+
+void CameraHandler::close() {
+    if (!impl) return;
+    // Buffers stay mapped until the last outstanding lease is released.
+    impl->stopStreaming();
+    impl.reset();
+}
+
+bool CameraHandler::grab(CapturedFrame& frame) {
+    if (!impl) return false;
+
+    uint8_t* data;
+    std::shared_ptr<void> lease;
+    if (impl->isDevice()) {
+        int index = impl->dequeueDevice();
+        if (index < 0) return false;
+        data = static_cast<uint8_t*>(impl->buffers[index].start);
+        // The lease also keeps Impl (and so the mapping) alive.
+        lease = std::shared_ptr<void>(data, [owner = impl, index](void*) { owner->requeue(index); });
+    } else {
+        data = impl->nextFileFrame();
+        lease = std::shared_ptr<void>(data, [owner = impl](void*) {});
+    }
+
+    frame.image = cv::Mat(matRowsOf(impl->format, impl->height), impl->width, matTypeOf(impl->format),
+                          data, impl->stride);
+    frame.format = impl->format;
+    frame.lease = std::move(lease); // Releases the slot's previous buffer
+    return true;
+}
+
+void toBGR(const CapturedFrame& frame, cv::Mat& bgr) {
+    switch (frame.format) {
+        case PixelFormat::YUYV:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_YUV2BGR_YUYV);
+            break;
+        case PixelFormat::NV12:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_YUV2BGR_NV12);
+            break;
+        case PixelFormat::BGR24:
+            bgr = frame.image;
+            break;
+    }
+}
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+void toGray(const CapturedFrame& frame, cv::Mat& gray) {
+    switch (frame.format) {
+        case PixelFormat::YUYV:
+            // As CV_8UC2 every pixel is (Y, U) or (Y, V), so channel 0 is the luma.
+            cv::extractChannel(frame.image, gray, 0);
+            break;
+        case PixelFormat::NV12:
+            gray = frame.image.rowRange(0, frame.image.rows * 2 / 3);
+            break;
+        case PixelFormat::BGR24:
+            cv::cvtColor(frame.image, gray, cv::COLOR_BGR2GRAY);
+            break;
     }
 }
@@ -3,16 +3,61 @@
 #define CAMERA_HANDLER_H
 
 #include <opencv2/opencv.hpp>
-#include <atomic>
-#include <mutex>
-#include "json.hpp"
-using json = nlohmann::json;
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "pipeline_config.h"
 
+enum class PixelFormat {
+    BGR24, // 8-bit B,G,R, 3 bytes per pixel
+    YUYV,  // Packed 4:2:2, 2 bytes per pixel (Y0 U Y1 V)
+    NV12   // Planar 4:2:0, full Y plane followed by interleaved UV at half resolution
+};
 
-extern std::atomic<bool> running;
-extern cv::Mat sharedFrame;
-extern std::mutex frameMutex;
+// A camera frame tagged with its position in the capture stream.
+struct CapturedFrame {
+    cv::Mat image; // Header over the capture buffer, in `format` layout
+    PixelFormat format = PixelFormat::BGR24;
+    uint64_t seq = 0; // Monotonic, starts at 1 for the first frame
+    std::chrono::steady_clock::time_point captured;
+    // Keeps the buffer behind `image` away from the driver while held.
+    // The buffer is re-queued once this and every copy of it are released.
+    std::shared_ptr<void> lease;
+};
 
-void captureLoop(cv::VideoCapture& cap);
+// Zero-copy camera capture.
+// A V4L2 device node is streamed through mmap'd driver buffers, and each frame
+// is handed out as a cv::Mat header over the driver's memory. If the configured
+// device is a regular file instead, it is treated as a raw dump of frames in the
+// configured pixel format (e.g. from `ffmpeg -f v4l2 ... -f rawvideo`) and played
+// back in a loop at camera.fileFps, so the pipeline can run without a camera.
+class CameraHandler {
+public:
+    CameraHandler();
+    ~CameraHandler();
+
+    bool open(const CameraConfig& config);
+    bool isOpened() const;
+    void close();
+
+    // Waits briefly for the next frame and stores it in `frame` (image, format,
+    // lease). Returns false on timeout or error; the caller just tries again.
+    // Does not touch frame.seq / frame.captured.
+    bool grab(CapturedFrame& frame);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> impl;
+};
+
+// Converts a captured frame to BGR, reusing `bgr`'s buffer where possible.
+// BGR24 frames are passed through as a header, without copying.
+void toBGR(const CapturedFrame& frame, cv::Mat& bgr);
+
+// Produces the luma plane for marker detection. NV12 frames are passed through
+// as a header over the Y plane, YUYV frames need one strided byte copy, and
+// only BGR24 frames need a real color conversion.
+void toGray(const CapturedFrame& frame, cv::Mat& gray);
 
 #endif
@@ -0,0 +1,116 @@
+#include "color_lut.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+const char LUT_MAGIC[4] = {'B', 'L', 'U', 'T'};
+constexpr uint8_t LUT_VERSION = 1;
+
+} // namespace
+
+ColorLUT::ColorLUT(int bits) : binBits(bits), table(size_t(1) << (3 * bits), 0) {}
+
+void ColorLUT::build(const Scalar& lowerHSV, const Scalar& upperHSV) {
+    lower = lowerHSV;
+    upper = upperHSV;
+
+    const int shift = 8 - binBits;
+    vector<uint32_t> inside(table.size(), 0);
+
+    // Classify every 24-bit colour once, one blue plane (256x256 pixels) at a time,
+    // and count how many colours of each bin land inside the bounds.
+    Mat plane(256, 256, CV_8UC3), hsv, mask;
+    for (int b = 0; b < 256; ++b) {
+        for (int g = 0; g < 256; ++g) {
+            Vec3b* row = plane.ptr<Vec3b>(g);
+            for (int r = 0; r < 256; ++r) {
+                row[r] = Vec3b(b, g, r);
+            }
+        }
+        cvtColor(plane, hsv, COLOR_BGR2HSV);
+        inRange(hsv, lower, upper, mask);
+
+        size_t bBin = size_t(b >> shift) << (2 * binBits);
+        for (int g = 0; g < 256; ++g) {
+            const uint8_t* m = mask.ptr<uint8_t>(g);
+            size_t gBin = bBin | (size_t(g >> shift) << binBits);
+            for (int r = 0; r < 256; ++r) {
+                if (m[r]) ++inside[gBin | (r >> shift)];
+            }
+        }
+    }
+
+    const uint32_t colorsPerBin = 1u << (3 * shift);
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] = (2 * inside[i] > colorsPerBin) ? 255 : 0;
+    }
+}
+
+void ColorLUT::classify(const Mat& bgr, Mat& mask) const {
+    CV_Assert(bgr.type() == CV_8UC3);
+    mask.create(bgr.rows, bgr.cols, CV_8UC1);
+
+    const int shift = 8 - binBits;
+    const uint8_t* lut = table.data();
+    for (int y = 0; y < bgr.rows; ++y) {
+        const uint8_t* p = bgr.ptr<uint8_t>(y);
+        uint8_t* m = mask.ptr<uint8_t>(y);
+        for (int x = 0; x < bgr.cols; ++x, p += 3) {
+            size_t index = (size_t(p[0] >> shift) << (2 * binBits)) | (size_t(p[1] >> shift) << binBits) | (p[2] >> shift);
+            m[x] = lut[index];
+        }
+    }
+}
+
+bool ColorLUT::save(const string& path) const {
+    ofstream file(path, ios::binary);
+    if (!file.is_open()) {
+        cerr << "[LUT] Cannot write " << path << endl;
+        return false;
+    }
+    uint8_t header[2] = {LUT_VERSION, static_cast<uint8_t>(binBits)};
+    int32_t bounds[6];
+    for (int i = 0; i < 3; ++i) {
+        bounds[i] = static_cast<int32_t>(lower[i]);
+        bounds[3 + i] = static_cast<int32_t>(upper[i]);
+    }
+    file.write(LUT_MAGIC, sizeof(LUT_MAGIC));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size());
+    return file.good();
+}
+
+bool ColorLUT::load(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) return false;
+
+    char magic[4];
+    uint8_t header[2];
+    int32_t bounds[6];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    file.read(reinterpret_cast<char*>(bounds), sizeof(bounds));
+    if (!file || !equal(magic, magic + 4, LUT_MAGIC) || header[0] != LUT_VERSION || header[1] < 1 || header[1] > 8) {
+        cerr << "[LUT] " << path << " is not a colour LUT file." << endl;
+        return false;
+    }
+
+    vector<uint8_t> loaded(size_t(1) << (3 * header[1]));
+    file.read(reinterpret_cast<char*>(loaded.data()), loaded.size());
+    if (!file) {
+        cerr << "[LUT] " << path << " is truncated." << endl;
+        return false;
+    }
+
+    binBits = header[1];
+    lower = Scalar(bounds[0], bounds[1], bounds[2]);
+    upper = Scalar(bounds[3], bounds[4], bounds[5]);
+    table.swap(loaded);
+    return true;
+}
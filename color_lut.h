@@ -0,0 +1,39 @@
+#ifndef CAM_ARUCO_COLOR_LUT_H
+#define CAM_ARUCO_COLOR_LUT_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Precomputed BGR -> in/out table for one colour class.
+// The BGR cube is split into (2^bits)^3 bins, and a bin is "in" if most of
+// the colours it covers fall inside the HSV bounds. classify() then turns a
+// BGR frame into a binary mask with one table lookup per pixel, replacing
+// cvtColor(BGR2HSV) + inRange and their intermediate 3-channel buffer.
+class ColorLUT {
+public:
+    // bits per channel: 5 gives a 32 KB table, 6 gives 256 KB
+    explicit ColorLUT(int bits = 5);
+
+    // Uses OpenCV's 8-bit HSV ranges (H 0-179, S and V 0-255).
+    void build(const cv::Scalar& lowerHSV, const cv::Scalar& upperHSV);
+
+    // Writes 255 for in-class pixels and 0 elsewhere. `mask` is reused.
+    void classify(const cv::Mat& bgr, cv::Mat& mask) const;
+
+    // Binary file with the bin size, the HSV bounds it was built from and the table.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    int bits() const { return binBits; }
+    const cv::Scalar& lowerBound() const { return lower; }
+    const cv::Scalar& upperBound() const { return upper; }
+
+private:
+    int binBits;
+    cv::Scalar lower, upper;
+    std::vector<uint8_t> table; // Indexed by (b << 2*bits) | (g << bits) | r, in bins
+};
+
+#endif //CAM_ARUCO_COLOR_LUT_H
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "bot_command.h"
+#include "command_frame.h"
+#include "command_publisher.h"
+#include "loopback_transport.h"
+#include "mqtt_publisher.h"
+#include "pipeline_config.h"
+
+// Measures the command payloads sent to the robots.
+//
+// Usage:
+//   command_bench encode [iterations]   JSON vs binary frame: bytes and encode time,
+//                                       exits 1 if a binary frame does not decode back
+//   command_bench publish [broker] [seconds] [rate_hz] [bots]
+//                                       binary frames through the async send path, with
+//                                       the mqtt settings of pipeline-config.json
+//   command_bench fanout [broker] [ticks]
+//                                       shared vs per-robot topics: time from publishCommands()
+//                                       until every payload is acknowledged, and bytes on the wire
+//   command_bench transports [ticks] [bots]
+//                                       loopback vs UDP to 127.0.0.1: time in publishCommands() and
+//                                       frame -> delivery age, no broker needed
+//
+// For publish and fanout, a local broker stands in for the real one (mosquitto -p 1883).
+// Pause it with kill -STOP / -CONT to see the queue replace stale commands.
+//
+// Bot counts cover a 1v1 match, 3v3, 6v6 and every marker ID.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int BOT_COUNTS[] = {2, 6, 12, 46};
+constexpr int FANOUT_BOT_COUNTS[] = {2, 6, 12};
+
+std::vector<BotCommand> randomCommands(std::mt19937& rng, int bots) {
+    std::uniform_real_distribution<float> motor(-1.0f, 1.0f);
+    std::vector<BotCommand> commands;
+    for (int i = 0; i < bots; ++i) commands.push_back({i, {motor(rng), motor(rng)}});
+    return commands;
+}
+
+int encode(int iterations) {
+    std::mt19937 rng(1234);
+    CommandFrameEncoder encoder;
+    CommandFrame decoded;
+    bool all_match = true;
+
+    std::cout << " bots  json(B)  binary(B)  json(us)  binary(us)  speedup  max error" << std::endl;
+    for (int bots : BOT_COUNTS) {
+        std::vector<BotCommand> commands = randomCommands(rng, bots);
+        CommandStamp stamp;
+        stamp.sequence = 7;
+        stamp.frameSeq = 1234;
+        stamp.captureTimeUs = commandTimestampNow() - 30000;
+
+        // What the JSON path does per publish: build the document, then serialize it
+        size_t json_bytes = 0;
+        auto start = Clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            stamp.publishTimeUs = commandTimestampNow();
+            json_bytes = commandsToJson(commands, stamp).dump().size();
+        }
+        double json_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+        size_t binary_bytes = 0;
+        start = Clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            stamp.publishTimeUs = commandTimestampNow();
+            binary_bytes = encoder.encode(commands, stamp).size();
+        }
+        double binary_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+        const std::vector<uint8_t>& frame = encoder.encode(commands, stamp);
+        float max_error = 0.0f;
+        bool decodes = decodeCommandFrame(frame.data(), frame.size(), decoded) && int(decoded.commands.size()) == bots
+                       && decoded.stamp.sequence == stamp.sequence && decoded.stamp.frameSeq == stamp.frameSeq
+                       && decoded.stamp.captureTimeUs == stamp.captureTimeUs
+                       && decoded.stamp.publishTimeUs == stamp.publishTimeUs;
+        for (int i = 0; decodes && i < bots; ++i) {
+            decodes = decoded.commands[i].id == commands[i].id;
+            max_error = std::max({max_error, std::abs(decoded.commands[i].cmd.left - commands[i].cmd.left),
+                                  std::abs(decoded.commands[i].cmd.right - commands[i].cmd.right)});
+        }
+        // Rounding to the int16 scale costs at most half a step
+        all_match = all_match && decodes && max_error <= 1.0f / 32767.0f;
+
+        std::cout << std::setw(5) << bots << std::setw(9) << json_bytes << std::setw(11) << binary_bytes
+                  << std::fixed << std::setprecision(3) << std::setw(10) << json_us << std::setw(12) << binary_us
+                  << std::setprecision(1) << std::setw(8) << json_us / binary_us << "x"
+                  << std::scientific << std::setw(11) << max_error << std::defaultfloat << std::endl;
+    }
+    std::cout << (all_match ? "Binary frames decode correctly" : "Binary frames do not decode") << std::endl;
+    return all_match ? 0 : 1;
+}
+
+int publish(const std::string& broker, double seconds, double rate_hz, int bots) {
+    PipelineConfig config = loadPipelineConfig("pipeline-config.json");
+    config.commands.transport = "mqtt";
+    config.commands.format = "binary";
+    config.mqtt.address = broker;
+    config.mqtt.asyncSend = true;
+    CommandPublisher publisher(config);
+    if (!publisher.connect()) return 1;
+
+    std::mt19937 rng(1234);
+    auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate_hz));
+    auto next = Clock::now();
+    auto end = next + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    uint64_t frame_seq = 0;
+    while (Clock::now() < end) {
+        auto start = Clock::now();
+        // Stands in for a camera frame captured just now
+        publisher.publishCommands(randomCommands(rng, bots), ++frame_seq, commandTimestampNow());
+        double call_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        next += period;
+        std::this_thread::sleep_until(next);
+
+        PublishStats stats = publisher.transport().stats();
+        if (stats.queued % uint64_t(std::max(rate_hz, 1.0)) == 0) {
+            std::cout << "queued " << stats.queued << "  sent " << stats.sent << "  superseded " << stats.superseded
+                      << "  dropped " << stats.dropped << "  failed " << stats.failed << "  depth " << stats.queueDepth
+                      << "  in flight " << stats.inFlight << "  latency " << stats.latencyMs << " ms (max "
+                      << stats.maxLatencyMs << ")  publish() " << call_us << " us" << std::endl;
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Let the last acknowledgements arrive
+    PublishStats stats = publisher.transport().stats();
+    publisher.disconnect();
+    std::cout << "Sent " << stats.sent << " of " << stats.queued << ", " << stats.superseded << " superseded, "
+              << stats.dropped << " dropped, " << stats.failed << " failed; queue max " << stats.maxQueueDepth
+              << ", latency ~" << stats.latencyMs << " ms, max " << stats.maxLatencyMs << " ms" << std::endl;
+    return stats.failed == 0 ? 0 : 1;
+}
+
+int fanout(const std::string& broker, int ticks) {
+    std::mt19937 rng(1234);
+    bool all_sent = true;
+
+    // wire: sent to the broker per tick. robot rx: what the broker sends each
+    // robot per tick, all robots' commands with the shared topic.
+    std::cout << "layout      bots  publish(us)  acked p50(ms)  p99(ms)  payload(B)  wire(B)  robot rx(B)" << std::endl;
+    for (const char* layout : {"shared", "per_robot"}) {
+        for (int bots : FANOUT_BOT_COUNTS) {
+            PipelineConfig config = loadPipelineConfig("pipeline-config.json");
+            config.commands.transport = "mqtt";
+            config.commands.format = "binary";
+            config.commands.layout = layout;
+            config.mqtt.address = broker;
+            config.mqtt.asyncSend = true;
+            CommandPublisher publisher(config);
+            if (!publisher.connect()) return 1;
+
+            int payloads_per_tick = std::string(layout) == "shared" ? 1 : bots;
+            std::vector<double> acked_ms;
+            double publish_us = 0.0;
+            for (int tick = 0; tick < ticks; ++tick) {
+                std::vector<BotCommand> commands = randomCommands(rng, bots);
+                uint64_t expected = uint64_t(tick + 1) * payloads_per_tick;
+
+                auto start = Clock::now();
+                publisher.publishCommands(commands, tick + 1, commandTimestampNow());
+                publish_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+                // Wait for this tick's acknowledgements before starting the next
+                PublishStats stats = publisher.transport().stats();
+                while (stats.sent + stats.failed < expected && Clock::now() - start < std::chrono::seconds(2)) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    stats = publisher.transport().stats();
+                }
+                acked_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+            PublishStats stats = publisher.transport().stats();
+            publisher.disconnect();
+            all_sent = all_sent && stats.sent == uint64_t(ticks) * payloads_per_tick;
+
+            CommandFrameEncoder encoder;
+            std::vector<BotCommand> commands = randomCommands(rng, bots);
+            size_t payload_bytes, robot_rx;
+            if (payloads_per_tick == 1) {
+                payload_bytes = encoder.encode(commands, CommandStamp()).size();
+                robot_rx = MQTTPublisher::wireBytes(config.mqtt.topic.size(), payload_bytes, config.mqtt.qos);
+            } else {
+                size_t frame_bytes = encoder.encode(commands.data(), 1, CommandStamp()).size();
+                payload_bytes = bots * frame_bytes;
+                std::string topic = config.mqtt.robotTopic;
+                if (topic.find("{id}") != std::string::npos) topic.replace(topic.find("{id}"), 4, "1");
+                robot_rx = MQTTPublisher::wireBytes(topic.size(), frame_bytes, config.mqtt.qos);
+            }
+            std::sort(acked_ms.begin(), acked_ms.end());
+            std::cout << std::left << std::setw(10) << layout << std::right << std::setw(6) << bots
+                      << std::fixed << std::setprecision(1) << std::setw(13) << publish_us / ticks
+                      << std::setprecision(2) << std::setw(15) << acked_ms[acked_ms.size() / 2]
+                      << std::setw(9) << acked_ms[std::min(acked_ms.size() - 1, acked_ms.size() * 99 / 100)]
+                      << std::setw(12) << payload_bytes << std::setw(9) << stats.wireBytes / std::max(ticks, 1)
+                      << std::setw(13) << robot_rx << std::defaultfloat << std::endl;
+        }
+    }
+    std::cout << (all_sent ? "Every payload acknowledged" : "Some payloads were not acknowledged") << std::endl;
+    return all_sent ? 0 : 1;
+}
+
+// Frame -> delivery age of one payload, in ms
+double payloadAgeMs(const CommandFrame& frame) {
+    return (double(commandTimestampNow()) - double(frame.stamp.captureTimeUs)) / 1000.0;
+}
+
+// Receives on 127.0.0.1:port like a robot on the shared port would
+int openUdpReceiver(int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(uint16_t(port));
+    timeval timeout{0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int transports(int ticks, int bots) {
+    PipelineConfig config = loadPipelineConfig("pipeline-config.json");
+    config.commands.format = "binary";
+    config.commands.layout = "shared";
+    config.udp.address = "127.0.0.1";
+    std::mt19937 rng(1234);
+    bool all_delivered = true;
+
+    std::cout << "transport  bots  publish(us)  age p50(ms)  p99(ms)  max(ms)  delivered  wire(B)" << std::endl;
+    for (const char* transport : {"loopback", "udp"}) {
+        std::vector<double> ages;
+        std::unique_ptr<CommandPublisher> publisher;
+        int receiver_fd = -1;
+        if (std::string(transport) == "loopback") {
+            auto loopback = std::make_unique<LoopbackTransport>(
+                    [&](int, const CommandFrame& frame) { ages.push_back(payloadAgeMs(frame)); });
+            publisher = std::make_unique<CommandPublisher>(config.commands, std::move(loopback));
+        } else {
+            receiver_fd = openUdpReceiver(config.udp.port);
+            if (receiver_fd < 0) {
+                std::cerr << "Cannot listen on 127.0.0.1:" << config.udp.port << std::endl;
+                return 1;
+            }
+            config.commands.transport = transport;
+            publisher = std::make_unique<CommandPublisher>(config);
+        }
+        if (!publisher->connect()) return 1;
+
+        std::vector<uint8_t> datagram(2048);
+        CommandFrame frame;
+        double publish_us = 0.0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            std::vector<BotCommand> commands = randomCommands(rng, bots);
+            auto start = Clock::now();
+            publisher->publishCommands(commands, tick + 1, commandTimestampNow());
+            publish_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            if (receiver_fd >= 0) {
+                ssize_t size = recv(receiver_fd, datagram.data(), datagram.size(), 0);
+                if (size > 0 && decodeCommandFrame(datagram.data(), size_t(size), frame)) {
+                    ages.push_back(payloadAgeMs(frame));
+                }
+            }
+        }
+        PublishStats stats = publisher->transport().stats();
+        publisher->disconnect();
+        if (receiver_fd >= 0) close(receiver_fd);
+        all_delivered = all_delivered && ages.size() == size_t(ticks);
+        if (ages.empty()) ages.push_back(0.0);
+
+        std::sort(ages.begin(), ages.end());
+        std::cout << std::left << std::setw(9) << transport << std::right << std::setw(6) << bots
+                  << std::fixed << std::setprecision(1) << std::setw(13) << publish_us / std::max(ticks, 1)
+                  << std::setprecision(3) << std::setw(13) << ages[ages.size() / 2]
+                  << std::setw(9) << ages[std::min(ages.size() - 1, ages.size() * 99 / 100)]
+                  << std::setw(9) << ages.back() << std::setw(11) << ages.size()
+                  << std::setw(9) << stats.wireBytes / std::max(ticks, 1) << std::defaultfloat << std::endl;
+    }
+    std::cout << (all_delivered ? "Every payload delivered" : "Some payloads were not delivered") << std::endl;
+    return all_delivered ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "";
+
+    if (command == "encode") {
+        return encode(argc > 2 ? std::stoi(argv[2]) : 100000);
+    }
+    if (command == "publish") {
+        return publish(argc > 2 ? argv[2] : "tcp://localhost:1883", argc > 3 ? std::stod(argv[3]) : 10.0,
+                       argc > 4 ? std::stod(argv[4]) : 10.0, argc > 5 ? std::stoi(argv[5]) : 6);
+    }
+    if (command == "fanout") {
+        return fanout(argc > 2 ? argv[2] : "tcp://localhost:1883", argc > 3 ? std::stoi(argv[3]) : 1000);
+    }
+    if (command == "transports") {
+        return transports(argc > 2 ? std::stoi(argv[2]) : 10000, argc > 3 ? std::stoi(argv[3]) : 6);
+    }
+    std::cerr << "Usage: command_bench encode [iterations]\n"
+              << "       command_bench publish [broker] [seconds] [rate_hz] [bots]\n"
+              << "       command_bench fanout [broker] [ticks]\n"
+              << "       command_bench transports [ticks] [bots]" << std::endl;
+    return 2;
+}
@@ -0,0 +1,110 @@
+#include "command_frame.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// Writes value little-endian, whatever the host byte order
+template <typename T>
+uint8_t* putLittleEndian(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = uint8_t(uint64_t(value) >> (8 * i));
+    }
+    return out + sizeof(T);
+}
+
+template <typename T>
+T getLittleEndian(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= uint64_t(in[i]) << (8 * i);
+    }
+    return T(value);
+}
+
+int16_t motorToInt16(float value) {
+    return int16_t(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+} // namespace
+
+CommandFrameEncoder::CommandFrameEncoder() {
+    buffer.reserve(COMMAND_FRAME_HEADER_SIZE + 64 * COMMAND_FRAME_ENTRY_SIZE);
+}
+
+const std::vector<uint8_t>& CommandFrameEncoder::encode(const BotCommand* commands, size_t count,
+                                                        const CommandStamp& stamp) {
+    count = std::min<size_t>(count, COMMAND_FRAME_MAX_COMMANDS);
+    buffer.resize(COMMAND_FRAME_HEADER_SIZE + count * COMMAND_FRAME_ENTRY_SIZE);
+
+    uint8_t* out = buffer.data();
+    *out++ = COMMAND_FRAME_VERSION;
+    *out++ = uint8_t(count);
+    out = putLittleEndian<uint32_t>(out, stamp.sequence);
+    out = putLittleEndian<uint32_t>(out, stamp.frameSeq);
+    out = putLittleEndian<uint64_t>(out, stamp.captureTimeUs);
+    out = putLittleEndian<uint64_t>(out, stamp.publishTimeUs);
+    for (size_t i = 0; i < count; ++i) {
+        *out++ = uint8_t(commands[i].id);
+        out = putLittleEndian<uint16_t>(out, uint16_t(motorToInt16(commands[i].cmd.left)));
+        out = putLittleEndian<uint16_t>(out, uint16_t(motorToInt16(commands[i].cmd.right)));
+    }
+    return buffer;
+}
+
+bool decodeCommandFrame(const uint8_t* data, size_t size, CommandFrame& frame) {
+    if (size < COMMAND_FRAME_HEADER_SIZE || data[0] != COMMAND_FRAME_VERSION) {
+        return false;
+    }
+    size_t count = data[1];
+    if (size != COMMAND_FRAME_HEADER_SIZE + count * COMMAND_FRAME_ENTRY_SIZE) {
+        return false;
+    }
+    frame.stamp.sequence = getLittleEndian<uint32_t>(data + 2);
+    frame.stamp.frameSeq = getLittleEndian<uint32_t>(data + 6);
+    frame.stamp.captureTimeUs = getLittleEndian<uint64_t>(data + 10);
+    frame.stamp.publishTimeUs = getLittleEndian<uint64_t>(data + 18);
+    frame.commands.clear();
+    const uint8_t* entry = data + COMMAND_FRAME_HEADER_SIZE;
+    for (size_t i = 0; i < count; ++i, entry += COMMAND_FRAME_ENTRY_SIZE) {
+        float left = int16_t(getLittleEndian<uint16_t>(entry + 1)) / 32767.0f;
+        float right = int16_t(getLittleEndian<uint16_t>(entry + 3)) / 32767.0f;
+        frame.commands.push_back({entry[0], {left, right}});
+    }
+    return true;
+}
+
+json commandsToJson(const BotCommand* commands, size_t count, const CommandStamp& stamp) {
+    json command_list = json::array();
+    for (size_t i = 0; i < count; ++i) {
+        const auto& [id, cmd] = commands[i];
+        command_list.push_back({{"id", id}, {"left", cmd.left}, {"right", cmd.right}});
+    }
+    return {{"seq", stamp.sequence},
+            {"frame", stamp.frameSeq},
+            {"captured_us", stamp.captureTimeUs},
+            {"published_us", stamp.publishTimeUs},
+            {"commands", command_list}};
+}
+
+bool commandsFromJson(const std::string& payload, CommandFrame& frame) {
+    json j = json::parse(payload, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || !j.contains("commands")) {
+        return false;
+    }
+    frame.stamp.sequence = j.value("seq", 0u);
+    frame.stamp.frameSeq = j.value("frame", 0u);
+    frame.stamp.captureTimeUs = j.value("captured_us", uint64_t(0));
+    frame.stamp.publishTimeUs = j.value("published_us", uint64_t(0));
+    frame.commands.clear();
+    for (const json& c : j["commands"]) {
+        frame.commands.push_back({c.value("id", -1), {c.value("left", 0.0f), c.value("right", 0.0f)}});
+    }
+    return true;
+}
+
+uint64_t commandTimestampNow() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
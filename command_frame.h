@@ -0,0 +1,77 @@
+#ifndef CAM_ARUCO_COMMAND_FRAME_H
+#define CAM_ARUCO_COMMAND_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bot_command.h"
+#include "json.hpp"
+using json = nlohmann::json;
+
+// Where a set of commands came from. Every payload carries it, so a robot can
+// tell fresh commands from ones that sat in a queue and drop stale ones.
+// Times are microseconds since the Unix epoch.
+struct CommandStamp {
+    uint32_t sequence = 0;      // +1 per publish; per-robot payloads of one publish share it
+    uint32_t frameSeq = 0;      // Camera frame the commands were computed from (low 32 bits)
+    uint64_t captureTimeUs = 0; // When that frame was captured
+    uint64_t publishTimeUs = 0; // When the payload was encoded
+};
+
+// Binary command frame, the compact alternative to the JSON payload. Fixed
+// layout, little-endian, no padding:
+//
+//   offset  size  field
+//   0       1     version (COMMAND_FRAME_VERSION)
+//   1       1     command count N
+//   2       4     sequence
+//   6       4     frame sequence
+//   10      8     capture time
+//   18      8     publish time
+//   26      5*N   per command: id (uint8), left (int16), right (int16)
+//
+// Motor values are scaled from [-1, 1] to [-32767, 32767].
+// Version 1 had no frame sequence or capture time.
+constexpr uint8_t COMMAND_FRAME_VERSION = 2;
+constexpr size_t COMMAND_FRAME_HEADER_SIZE = 26;
+constexpr size_t COMMAND_FRAME_ENTRY_SIZE = 5;
+constexpr int COMMAND_FRAME_MAX_COMMANDS = 255;
+
+// Encodes command frames into one reused buffer
+class CommandFrameEncoder {
+public:
+    CommandFrameEncoder();
+
+    // The returned buffer is valid until the next call. Does not allocate for
+    // up to 64 commands; commands past COMMAND_FRAME_MAX_COMMANDS are dropped.
+    const std::vector<uint8_t>& encode(const BotCommand* commands, size_t count, const CommandStamp& stamp);
+    const std::vector<uint8_t>& encode(const std::vector<BotCommand>& commands, const CommandStamp& stamp) {
+        return encode(commands.data(), commands.size(), stamp);
+    }
+
+private:
+    std::vector<uint8_t> buffer;
+};
+
+struct CommandFrame {
+    CommandStamp stamp;
+    std::vector<BotCommand> commands;
+};
+
+// What a robot does with a frame. Returns false if data is not a complete frame.
+bool decodeCommandFrame(const uint8_t* data, size_t size, CommandFrame& frame);
+
+// The JSON payload: {"seq":..,"frame":..,"captured_us":..,"published_us":..,
+// "commands":[{"id":..,"left":..,"right":..},...]}
+json commandsToJson(const BotCommand* commands, size_t count, const CommandStamp& stamp);
+inline json commandsToJson(const std::vector<BotCommand>& commands, const CommandStamp& stamp) {
+    return commandsToJson(commands.data(), commands.size(), stamp);
+}
+// Reads a JSON payload back. Returns false if it is not one.
+bool commandsFromJson(const std::string& payload, CommandFrame& frame);
+
+// Microseconds since the Unix epoch, the clock of CommandStamp
+uint64_t commandTimestampNow();
+
+#endif //CAM_ARUCO_COMMAND_FRAME_H
@@ -0,0 +1,81 @@
+#include "command_publisher.h"
+#include <iostream>
+#include <string>
+#include "loopback_transport.h"
+#include "mqtt_publisher.h"
+#include "udp_transport.h"
+
+std::unique_ptr<CommandTransport> CommandPublisher::createTransport(const PipelineConfig& config) {
+    const std::string& type = config.commands.transport;
+    if (type == "udp") {
+        return std::make_unique<UdpTransport>(config.udp);
+    }
+    if (type == "loopback") {
+        return std::make_unique<LoopbackTransport>();
+    }
+    if (type != "mqtt") {
+        std::cerr << "[Commands] Unknown transport '" << type << "', using 'mqtt'." << std::endl;
+    }
+    return std::make_unique<MQTTPublisher>(config.mqtt, parseLayout(config.commands.layout) == Layout::PER_ROBOT);
+}
+
+CommandPublisher::CommandPublisher(const PipelineConfig& config)
+    : CommandPublisher(config.commands, createTransport(config)) {}
+
+CommandPublisher::CommandPublisher(const CommandsConfig& config, std::unique_ptr<CommandTransport> transport)
+    : format(parseFormat(config.format)), layout(parseLayout(config.layout)), commandTransport(std::move(transport)) {}
+
+CommandPublisher::Format CommandPublisher::parseFormat(const std::string& name) {
+    if (name == "binary") return Format::BINARY;
+    if (name != "json") {
+        std::cerr << "[Commands] Unknown format '" << name << "', using 'json'." << std::endl;
+    }
+    return Format::JSON;
+}
+
+CommandPublisher::Layout CommandPublisher::parseLayout(const std::string& name) {
+    if (name == "per_robot") return Layout::PER_ROBOT;
+    if (name != "shared") {
+        std::cerr << "[Commands] Unknown layout '" << name << "', using 'shared'." << std::endl;
+    }
+    return Layout::SHARED;
+}
+
+bool CommandPublisher::connect() {
+    return commandTransport->connect();
+}
+
+void CommandPublisher::disconnect() {
+    commandTransport->disconnect();
+}
+
+void CommandPublisher::publishCommands(const std::vector<BotCommand>& commands, uint64_t frameSeq, uint64_t captureTimeUs) {
+    if (commands.empty()) {
+        return;
+    }
+    CommandStamp stamp;
+    stamp.sequence = nextSequence++;
+    stamp.frameSeq = uint32_t(frameSeq);
+    stamp.captureTimeUs = captureTimeUs;
+    stamp.publishTimeUs = commandTimestampNow();
+
+    if (layout == Layout::PER_ROBOT) {
+        for (const BotCommand& command : commands) {
+            if (format == Format::BINARY) {
+                const std::vector<uint8_t>& frame = frameEncoder.encode(&command, 1, stamp);
+                commandTransport->send(command.id, frame.data(), frame.size());
+            } else {
+                std::string payload = commandsToJson(&command, 1, stamp).dump();
+                commandTransport->send(command.id, payload.data(), payload.size());
+            }
+        }
+    } else if (format == Format::BINARY) {
+        const std::vector<uint8_t>& frame = frameEncoder.encode(commands, stamp);
+        commandTransport->send(CommandTransport::ALL_ROBOTS, frame.data(), frame.size());
+    } else {
+        std::string payload = commandsToJson(commands, stamp).dump();
+        std::cout << "Publishing AI Commands: " << payload << std::endl;
+        commandTransport->send(CommandTransport::ALL_ROBOTS, payload.data(), payload.size());
+    }
+    commandTransport->flush();
+}
@@ -0,0 +1,53 @@
+#ifndef CAM_ARUCO_COMMAND_PUBLISHER_H
+#define CAM_ARUCO_COMMAND_PUBLISHER_H
+
+#include <memory>
+#include <vector>
+#include "bot_command.h"
+#include "command_frame.h"
+#include "command_transport.h"
+#include "pipeline_config.h"
+
+// Turns the AI's commands into payloads (see CommandsConfig) and hands them
+// to the configured transport.
+class CommandPublisher {
+public:
+    // JSON is readable on the wire; BINARY is the fixed-layout command frame
+    // from command_frame.h, smaller and cheaper for the robots to parse.
+    enum class Format { JSON, BINARY };
+    // See CommandsConfig::layout
+    enum class Layout { SHARED, PER_ROBOT };
+
+    explicit CommandPublisher(const PipelineConfig& config);
+    // For a transport built elsewhere, e.g. a LoopbackTransport with a receiver
+    CommandPublisher(const CommandsConfig& config, std::unique_ptr<CommandTransport> transport);
+
+    // Returns false if the transport cannot send
+    bool connect();
+    void disconnect();
+
+    // Encodes commands in the configured format and sends them, as one
+    // payload or one per robot. Per-robot payloads are sent back-to-back and
+    // share a sequence number. Every payload is stamped with the camera frame
+    // the commands were computed from (see CommandStamp). Does nothing for an
+    // empty command list.
+    void publishCommands(const std::vector<BotCommand>& commands, uint64_t frameSeq, uint64_t captureTimeUs);
+
+    CommandTransport& transport() { return *commandTransport; }
+
+    // "json" or "binary"; anything else is reported and read as JSON
+    static Format parseFormat(const std::string& name);
+    // "shared" or "per_robot"; anything else is reported and read as shared
+    static Layout parseLayout(const std::string& name);
+    // "mqtt", "udp" or "loopback"; anything else is reported and built as MQTT
+    static std::unique_ptr<CommandTransport> createTransport(const PipelineConfig& config);
+
+private:
+    Format format;
+    Layout layout;
+    std::unique_ptr<CommandTransport> commandTransport;
+    CommandFrameEncoder frameEncoder; // Binary frames are encoded into its reused buffer
+    uint32_t nextSequence = 0;
+};
+
+#endif //CAM_ARUCO_COMMAND_PUBLISHER_H
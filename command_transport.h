@@ -0,0 +1,47 @@
+#ifndef CAM_ARUCO_COMMAND_TRANSPORT_H
+#define CAM_ARUCO_COMMAND_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Counters of a transport's send path
+struct PublishStats {
+    uint64_t queued = 0;     // Payloads handed to send()
+    uint64_t sent = 0;       // ... delivered (MQTT: acknowledged by the broker, or written to the socket at QoS 0)
+    uint64_t superseded = 0; // ... replaced in a queue by a newer payload for the same robot(s)
+    uint64_t dropped = 0;    // ... pushed out of a full queue, or refused by a full socket buffer
+    uint64_t failed = 0;     // ... rejected, or never acknowledged
+    int queueDepth = 0;      // Payloads waiting now
+    int maxQueueDepth = 0;
+    int inFlight = 0;        // Sent, not yet acknowledged
+    double latencyMs = 0.0;  // Running average, send() to delivery
+    double maxLatencyMs = 0.0;
+    uint64_t wireBytes = 0;  // Bytes on the wire for the sent payloads, protocol overhead included
+};
+
+// Carries encoded command payloads to the robots. CommandPublisher does the
+// encoding; a transport only moves bytes. See CommandsConfig::transport.
+class CommandTransport {
+public:
+    // send()'s robot ID for a payload meant for every robot
+    static constexpr int ALL_ROBOTS = -1;
+
+    virtual ~CommandTransport() = default;
+
+    // Returns false if the transport cannot send; send() then fails each payload
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+
+    // Sends one payload, for robot robotId alone or for ALL_ROBOTS. Must not
+    // block on the network. May hold the payload until flush().
+    virtual void send(int robotId, const void* data, size_t size) = 0;
+    // Called once after the payloads of one publish
+    virtual void flush() {}
+
+    // Safe to call from any thread
+    virtual PublishStats stats() const = 0;
+    virtual std::string name() const = 0;
+};
+
+#endif //CAM_ARUCO_COMMAND_TRANSPORT_H
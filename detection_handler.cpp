@@ -3,48 +3,157 @@
 #include "bot_detector.h"
 #include "ball_detector.h"
 #include "ai_handler.h"
+#include "inference_stage.h"
+#include "marker_detector.h"
+#include "ball_tracker.h"
 #include <opencv2/opencv.hpp>
+#include <memory>
 #include <thread>
-#include "mqtt_publisher.h"
-#include "json.hpp"
+#include "command_publisher.h"
 #include "world_state.h"
 #include <iostream>
 
-using json = nlohmann::json;
 using namespace cv;
 using namespace std;
 
+// Maps the last known bots and the tracked balls into the top-down arena frame.
+// Reuses world's vectors; leaves them empty until the homography is known.
+// A bot is marked is_ai if one of the AI's policies drives it.
+static void buildWorldState(SharedState& state, const vector<Ball>& currentBalls, const CapturedFrame& captured,
+                            const AIHandler& ai, WorldState& world) {
+    world.bots.clear();
+    world.balls.clear();
+
+    // Stamp the state with its frame, on the wall clock the robots can compare against
+    auto age = chrono::steady_clock::now() - captured.captured;
+    world.frameSeq = captured.seq;
+    world.captureTimeUs = chrono::duration_cast<chrono::microseconds>(
+            (chrono::system_clock::now() - age).time_since_epoch()).count();
+
+    Mat H_for_transform;
+    vector<DetectedBot> bots_to_transform;
+    {
+        lock_guard<mutex> lock(state.dataMutex);
+        H_for_transform = state.last_known_H;
+        bots_to_transform = state.last_known_bots;
+    }
+    if (H_for_transform.empty()) {
+        return;
+    }
+
+    // Transform bot positions
+    if (!bots_to_transform.empty()) {
+        vector<Point2f> bot_centers_in, bot_centers_out;
+        for(const auto& bot : bots_to_transform) { bot_centers_in.push_back(bot.center); }
+        perspectiveTransform(bot_centers_in, bot_centers_out, H_for_transform);
+        for (size_t i = 0; i < bots_to_transform.size(); ++i) {
+            int id = bots_to_transform[i].id;
+            world.bots.push_back({id, bot_centers_out[i], bots_to_transform[i].angleDeg, ai.drives(id)});
+        }
+    }
+
+    // Transform all tracked ball positions to the top-down view. Velocity is
+    // mapped by transforming where each ball will be 0.1 s from now.
+    if (!currentBalls.empty()) {
+        const float velocity_dt = 0.1f;
+        vector<Point2f> ball_centers_in, ball_centers_out;
+        for(const auto& ball : currentBalls) {
+            ball_centers_in.push_back(ball.center);
+            ball_centers_in.push_back(ball.center + ball.velocity * velocity_dt);
+        }
+        perspectiveTransform(ball_centers_in, ball_centers_out, H_for_transform);
+
+        // Add all transformed balls to the world state, in track ID order
+        for(size_t i = 0; i < currentBalls.size(); ++i) {
+            Ball ball{ball_centers_out[2 * i], currentBalls[i].radius, currentBalls[i].id};
+            ball.velocity = (ball_centers_out[2 * i + 1] - ball_centers_out[2 * i]) / velocity_dt;
+            world.balls.push_back(ball);
+        }
+    }
+}
+
 // This is the main processing thread for the application.
-void detectionLoop(const Mat& cameraMatrix, const Mat& distCoeffs,
+void detectionLoop(const PipelineConfig& config, const Mat& cameraMatrix, const Mat& distCoeffs,
                    float markerLength, SharedState& state) {
 
     // --- INITIALIZATION ---
-    MQTTPublisher mqtt("tcp://192.168.0.122:1883", "robots/commands");
-    mqtt.connect();
+    CommandPublisher publisher(config);
+    if (!publisher.connect()) {
+        // Vision and the AI still run, so the pipeline can be checked without robots
+        cerr << "[Commands] No " << publisher.transport().name() << " connection; commands will not be sent." << endl;
+    }
 
-    AIHandler ai_handler("RobotSoccerTeamA.onnx");
+    AIHandler ai_handler(config.ai);
+    MarkerDetector markers(config.markers); // Dictionary and detector are built once, here
+    ArenaDetector arena(config.arena);
+    BallDetector ballDetector(config.balls);
+    BallTracker ballTracker(config.ballTracker);
+    vector<Rect> ballWindows;
+
+    // With ai.async, inference and publishing run on their own thread
+    unique_ptr<InferenceStage> inference;
+    if (config.ai.async) {
+        inference = make_unique<InferenceStage>(ai_handler, publisher, config.ai.rateHz);
+        inference->start();
+    }
+    WorldState world; // Rebuilt in place each time; its vectors are reused
 
+    auto aiPeriod = chrono::duration_cast<chrono::steady_clock::duration>(
+            chrono::duration<double>(1.0 / max(config.ai.rateHz, 0.1)));
     auto lastUpdate = chrono::steady_clock::now();
+    auto fpsStart = lastUpdate;
+    int fpsFrames = 0;
+    uint64_t lastSeq = 0;
+    Mat frame; // BGR view of the current frame, for balls and display; its buffer is reused
+    Mat gray;  // Luma plane of the current frame, for marker detection
 
     // --- MAIN LOOP ---
     while (state.running) {
-        // 1. GET LATEST FRAME (runs on every loop)
-        Mat frame;
-        {
-            lock_guard<mutex> lock(state.frameMutex);
-            if (state.sharedFrame.empty()) {
-                this_thread::sleep_for(chrono::milliseconds(10));
-                continue;
-            }
-            state.sharedFrame.copyTo(frame);
+        // 1. WAIT FOR A NEW FRAME (runs on every loop)
+        // Sleeps until the camera publishes a new sequence; the timeout only
+        // exists so we notice state.running going false.
+        if (state.frameSignal.waitNewer(lastSeq, chrono::milliseconds(100)) == lastSeq) {
+            continue;
         }
+        // Swaps the newest published slot in; the frame is not copied.
+        state.frames.acquire();
+        const CapturedFrame& captured = state.frames.frontSlot();
+        if (captured.seq == lastSeq || captured.image.empty()) {
+            continue;
+        }
+        lastSeq = captured.seq;
+        toBGR(captured, frame);
+        toGray(captured, gray);
 
         Mat displayFrame = frame.clone();
 
+        // Detection FPS, to compare runs with ai.async on and off
+        ++fpsFrames;
+        if (captured.captured - fpsStart >= chrono::seconds(2)) {
+            double seconds = chrono::duration<double>(captured.captured - fpsStart).count();
+            cout << "[Detection] " << fpsFrames / seconds << " FPS ("
+                 << (inference ? "async" : "inline") << " inference)" << endl;
+            fpsStart = captured.captured;
+            fpsFrames = 0;
+        }
+
         // 2. DETECT EVERYTHING (runs on every loop)
-        vector<Ball> currentBalls = detectOrangeBalls(frame);
-        Mat current_H = detectArenaMarkers(frame, displayFrame, cameraMatrix, distCoeffs, markerLength, currentBalls);
-        vector<DetectedBot> current_bots = detectBots(frame, displayFrame, cameraMatrix, distCoeffs, markerLength);
+        // Balls are searched for near their predicted positions, with periodic full scans
+        bool fullBallScan = ballTracker.needsFullScan();
+        vector<Ball> ballDetections;
+        if (fullBallScan) {
+            ballDetections = ballDetector.detect(frame);
+        } else {
+            ballTracker.searchWindows(captured.captured, frame.size(), ballWindows);
+            ballDetections = ballDetector.detect(frame, ballWindows);
+        }
+        vector<Ball> currentBalls = ballTracker.update(ballDetections, captured.captured, fullBallScan);
+        // One ArUco pass for all markers. It works on grayscale, so passing the
+        // luma plane skips its internal BGR->gray conversion.
+        // Once the arena homography is locked, its markers are only searched for when it is re-verified.
+        markers.detect(gray, arena.needsMarkers());
+        Mat current_H = arena.update(markers.arenaMarkers(), displayFrame, currentBalls);
+        vector<DetectedBot> current_bots = detectBots(markers.botMarkers(), displayFrame, cameraMatrix, distCoeffs, markerLength);
 
         // 3. UPDATE SHARED STATE (runs on every loop)
         {
@@ -57,64 +166,26 @@ void detectionLoop(const Mat& cameraMatrix, const Mat& distCoeffs,
             }
         }
 
-        // --- AI, PUBLISHING, AND VISUALIZATION (Throttled to run ~10 times per second) ---
+        // 4. BUILD WORLD STATE for the AI
+        // In async mode it is built every frame so the inference stage always
+        // gets the freshest state; inline, only when a command is due.
         auto now = chrono::steady_clock::now();
-        auto elapsed = chrono::duration_cast<chrono::milliseconds>(now - lastUpdate).count();
-
-        if (elapsed >= 100) {
-            lastUpdate = now; // Reset the timer
-
-            // 4. BUILD WORLD STATE for the AI
-            WorldState world;
-            {
-                Mat H_for_transform;
-                vector<DetectedBot> bots_to_transform;
-                {
-                    lock_guard<mutex> lock(state.dataMutex);
-                    H_for_transform = state.last_known_H;
-                    bots_to_transform = state.last_known_bots;
-                }
+        bool due = now - lastUpdate >= aiPeriod;
+        if (config.ai.async || due) {
+            buildWorldState(state, currentBalls, captured, ai_handler, world);
+        }
 
-                if (!H_for_transform.empty()) {
-                    // Transform bot positions
-                    if (!bots_to_transform.empty()) {
-                        vector<Point2f> bot_centers_in, bot_centers_out;
-                        for(const auto& bot : bots_to_transform) { bot_centers_in.push_back(bot.center); }
-                        perspectiveTransform(bot_centers_in, bot_centers_out, H_for_transform);
-                        for (size_t i = 0; i < bots_to_transform.size(); ++i) {
-                            world.bots.push_back({bots_to_transform[i].id, bot_centers_out[i], bots_to_transform[i].angleDeg, bots_to_transform[i].isAI});
-                        }
-                    }
-
-                    // --- MODIFIED BALL HANDLING ---
-                    // Transform all detected ball positions to the top-down view
-                    if (!currentBalls.empty()) {
-                        vector<Point2f> ball_centers_in, ball_centers_out;
-                        for(const auto& ball : currentBalls) {
-                            ball_centers_in.push_back(ball.center);
-                        }
-                        perspectiveTransform(ball_centers_in, ball_centers_out, H_for_transform);
-
-                        // Add all transformed balls to the world state
-                        for(size_t i = 0; i < currentBalls.size(); ++i) {
-                            world.balls.push_back({ball_centers_out[i], currentBalls[i].radius, currentBalls[i].id});
-                        }
-                    }
-                }
-            }
+        // 5-6. GET AND PUBLISH MOVEMENT COMMANDS
+        if (inference) {
+            inference->post(world); // Never blocks; the stage runs at its own rate
+        }
 
-            // 5. GET MOVEMENT COMMANDS from the AI
-            auto commands = ai_handler.predictMovements(world);
+        // --- INLINE AI AND VISUALIZATION (Throttled to config.ai.rateHz) ---
+        if (due) {
+            lastUpdate = now; // Reset the timer
 
-            // 6. BUILD AND PUBLISH COMMANDS via MQTT
-            if (!commands.empty()) {
-                json command_list = json::array();
-                for (const auto& [id, cmd] : commands) {
-                    command_list.push_back({{"id", id}, {"left", cmd.left}, {"right", cmd.right}});
-                }
-                json command_payload = {{"commands", command_list}};
-                cout << "Publishing AI Commands: " << command_payload.dump() << endl;
-                mqtt.publish(command_payload.dump());
+            if (!inference) {
+                publisher.publishCommands(ai_handler.predictMovements(world), world.frameSeq, world.captureTimeUs);
             }
 
             // 7. DRAW TOP-DOWN VIEW
@@ -142,23 +213,38 @@ void detectionLoop(const Mat& cameraMatrix, const Mat& distCoeffs,
 
         // --- Show the main camera view (runs on every loop) ---
         imshow("Arena View", displayFrame);
-        if (waitKey(1) == 'q') {
+        int key = waitKey(1);
+        if (key == 'q') {
             state.running = false;
             break;
         }
+        if (key == 'r') {
+            arena.unlock(); // Re-estimate the homography, e.g. after moving the camera
+        }
+        if (key == 'm') {
+            ai_handler.reloadModel(); // Loads in the background; inference keeps running
+        }
+        if (key == 'v') {
+            // Cycle the policy trace: off -> record -> record and print
+            int level = (ai_handler.trace().level() + 1) % (TraceRing::PRINT + 1);
+            ai_handler.trace().setLevel(level);
+            cout << "[AI] Trace level " << level << endl;
+        }
     }
 }
 
 // This is the camera thread loop. It's separate from the detection handler.
-void captureLoop(VideoCapture& cap, SharedState& state) {
-    Mat local;
+void captureLoop(CameraHandler& camera, SharedState& state) {
+    uint64_t seq = 0;
     while (state.running) {
-        cap >> local;
-        if (local.empty()) continue;
-        {
-            lock_guard<mutex> lock(state.frameMutex);
-            local.copyTo(state.sharedFrame);
-        }
-        this_thread::sleep_for(chrono::milliseconds(1));
+        // The back slot receives a header over the next driver buffer. Its
+        // previous buffer goes back to the driver once no one else holds it.
+        // grab() blocks until the driver has a frame, so no sleep is needed.
+        CapturedFrame& slot = state.frames.backSlot();
+        if (!camera.grab(slot)) continue;
+        slot.captured = chrono::steady_clock::now();
+        slot.seq = ++seq;
+        state.frames.publish();
+        state.frameSignal.notify(seq);
     }
 }
\ No newline at end of file
@@ -7,14 +7,17 @@
 #include <vector>
 #include "ball_detector.h"
 #include "bot_detector.h" // <-- ADDED: We need to know about DetectedBot
+#include "camera_handler.h"
+#include "pipeline_config.h"
+#include "frame_buffer.h"
 #include "json.hpp"
 
 using json = nlohmann::json;
 
 struct SharedState {
     std::atomic<bool> running;
-    cv::Mat sharedFrame;
-    std::mutex frameMutex;
+    TripleBuffer<CapturedFrame> frames; // Camera thread writes, detection thread reads
+    FrameSignal frameSignal;            // Raised once per published frame
 
     // --- MODIFIED STATE ---
     std::mutex dataMutex; // A single mutex for all our shared data
@@ -24,8 +27,8 @@ struct SharedState {
     SharedState() : running(true) {}
 };
 
-void captureLoop(cv::VideoCapture& cap, SharedState& state);
-void detectionLoop(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+void captureLoop(CameraHandler& camera, SharedState& state);
+void detectionLoop(const PipelineConfig& config, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
                    float markerLength, SharedState& state);
 
 #endif // DETECTION_HANDLER_H
\ No newline at end of file
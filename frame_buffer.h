@@ -0,0 +1,81 @@
+#ifndef CAM_ARUCO_FRAME_BUFFER_H
+#define CAM_ARUCO_FRAME_BUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Lock-free triple buffer for one producer thread and one consumer thread.
+// The producer fills backSlot() and publish()es it by swapping its index with
+// the shared "middle" slot. The consumer calls acquire() to swap the newest
+// published slot into frontSlot(). Payloads are never copied and neither side
+// ever waits on the other.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), back(2), front(0) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // --- Producer side ---
+    T& backSlot() { return slots[back]; }
+
+    void publish() {
+        uint8_t previous = middle.exchange(back | DIRTY_BIT, std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // --- Consumer side ---
+    // Returns true if a newer slot was published since the last acquire().
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & DIRTY_BIT)) {
+            return false;
+        }
+        uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX_MASK;
+        return true;
+    }
+
+    T& frontSlot() { return slots[front]; }
+    const T& frontSlot() const { return slots[front]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY_BIT = 0x4;
+
+    T slots[3];
+    alignas(64) std::atomic<uint8_t> middle; // Index of the shared slot, plus DIRTY_BIT when unread
+    alignas(64) uint8_t back;                // Owned by the producer
+    alignas(64) uint8_t front;               // Owned by the consumer
+};
+
+// Wakes the consumer when the producer publishes a new sequence number, so
+// the consumer can sleep instead of polling the buffer.
+class FrameSignal {
+public:
+    void notify(uint64_t seq) {
+        {
+            std::lock_guard<std::mutex> lock(signalMutex);
+            latest = seq;
+        }
+        newFrame.notify_one();
+    }
+
+    // Blocks until a sequence newer than lastSeen is published or the timeout
+    // expires. Returns the latest published sequence either way.
+    uint64_t waitNewer(uint64_t lastSeen, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(signalMutex);
+        newFrame.wait_for(lock, timeout, [&] { return latest != lastSeen; });
+        return latest;
+    }
+
+private:
+    std::mutex signalMutex;
+    std::condition_variable newFrame;
+    uint64_t latest = 0;
+};
+
+#endif //CAM_ARUCO_FRAME_BUFFER_H
@@ -1,5 +1,7 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include <string>
+#include "color_lut.h"
 
 // Global variables for trackbar values
 int lowH = 5, highH = 25;
@@ -9,7 +11,11 @@ int lowV = 100, highV = 255;
 // Callback function for the trackbars (does nothing, but is required)
 void on_trackbar(int, void*) {}
 
-int main() {
+// Usage: hsv_tuner [lut_output_path]
+// On exit the final bounds are also exported as a colour LUT for the ball detector.
+int main(int argc, char** argv) {
+    std::string lutPath = argc > 1 ? argv[1] : "ball-lut.bin";
+
     // --- Camera Setup ---
     // Change the '0' if your camera is not the default one (e.g., to 1, 2, etc.)
     cv::VideoCapture cap(2);
@@ -63,5 +69,12 @@ int main() {
     std::cout << "Scalar lowerOrange(" << lowH << ", " << lowS << ", " << lowV << ");" << std::endl;
     std::cout << "Scalar upperOrange(" << highH << ", " << highS << ", " << highV << ");" << std::endl;
 
+    // --- Export the LUT used by the detector's fast path ---
+    ColorLUT lut;
+    lut.build(cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV));
+    if (lut.save(lutPath)) {
+        std::cout << "Colour LUT written to " << lutPath << std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file
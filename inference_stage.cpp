@@ -0,0 +1,45 @@
+#include "inference_stage.h"
+#include <algorithm>
+
+InferenceStage::InferenceStage(AIHandler& ai, CommandPublisher& publisher, double rateHz)
+    : ai(ai), publisher(publisher),
+      period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(1.0 / std::max(rateHz, 0.1)))) {}
+
+InferenceStage::~InferenceStage() {
+    stop();
+}
+
+void InferenceStage::start() {
+    if (running.exchange(true)) return;
+    worker = std::thread(&InferenceStage::run, this);
+}
+
+void InferenceStage::stop() {
+    running = false;
+    if (worker.joinable()) worker.join();
+}
+
+void InferenceStage::post(const WorldState& world) {
+    // Assigning into the slot reuses its vectors' capacity
+    WorldState& slot = mailbox.backSlot();
+    slot.bots = world.bots;
+    slot.balls = world.balls;
+    mailbox.publish();
+}
+
+void InferenceStage::run() {
+    auto next = std::chrono::steady_clock::now();
+    while (running) {
+        std::this_thread::sleep_until(next);
+        next += period;
+
+        if (!mailbox.acquire()) {
+            continue; // Nothing new since the last tick
+        }
+        const WorldState& world = mailbox.frontSlot();
+        const auto& commands = ai.predictMovements(world);
+        publisher.publishCommands(commands, world.frameSeq, world.captureTimeUs);
+        ++runCount;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef CAM_ARUCO_INFERENCE_STAGE_H
+#define CAM_ARUCO_INFERENCE_STAGE_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "ai_handler.h"
+#include "frame_buffer.h"
+#include "command_publisher.h"
+#include "world_state.h"
+
+// Runs AI inference and command publishing on their own thread at a fixed
+// rate, so a slow session.Run() never stalls frame processing. The detection
+// loop post()s its latest WorldState into a single-slot mailbox (a triple
+// buffer, so neither side waits). Each tick the stage takes the newest state
+// and skips the tick if nothing new was posted.
+class InferenceStage {
+public:
+    InferenceStage(AIHandler& ai, CommandPublisher& publisher, double rateHz);
+    ~InferenceStage();
+
+    void start();
+    void stop();
+
+    // Never blocks. A state that has not been consumed yet is replaced.
+    void post(const WorldState& world);
+
+    // Number of inference runs so far
+    uint64_t runs() const { return runCount; }
+
+private:
+    void run();
+
+    AIHandler& ai;
+    CommandPublisher& publisher;
+    std::chrono::steady_clock::duration period;
+
+    TripleBuffer<WorldState> mailbox;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> runCount{0};
+    std::thread worker;
+};
+
+#endif //CAM_ARUCO_INFERENCE_STAGE_H
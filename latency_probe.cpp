@@ -0,0 +1,127 @@
+#include <mqtt/async_client.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "command_frame.h"
+#include "pipeline_config.h"
+
+// Subscribes to the command topics like a robot would and measures how old
+// the commands are when they arrive, from the stamp every payload carries:
+//   frame -> publish   capture of the camera frame until the payload was encoded
+//   publish -> recv    encoding until it reached this subscriber (queue, broker, network)
+//   frame -> recv      the two together, the age a robot acts on
+// Run it on the pipeline host against a local broker so both ends share one
+// clock. Binary and JSON payloads are both understood.
+//
+// Usage:
+//   latency_probe [broker] [seconds] [stale_ms]
+// The broker and topics default to the mqtt settings of pipeline-config.json.
+// Payloads older than stale_ms on arrival (default 100) are counted as stale.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Distribution {
+    std::vector<double> samples;
+
+    void print(const char* name) {
+        if (samples.empty()) return;
+        std::sort(samples.begin(), samples.end());
+        auto at = [&](double p) { return samples[std::min(samples.size() - 1, size_t(p * samples.size()))]; };
+        std::cout << "  " << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(2)
+                  << "p50 " << std::setw(8) << at(0.5) << "  p90 " << std::setw(8) << at(0.9)
+                  << "  p99 " << std::setw(8) << at(0.99) << "  max " << std::setw(8) << samples.back() << " ms"
+                  << std::defaultfloat << std::endl;
+    }
+};
+
+struct TopicState {
+    bool seen = false;
+    uint32_t lastSequence = 0;
+};
+
+std::string subscriptionFilter(const std::string& robot_topic) {
+    std::string filter = robot_topic;
+    size_t at = filter.find("{id}");
+    if (at != std::string::npos) filter.replace(at, 4, "+");
+    return filter;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    MqttConfig config = loadPipelineConfig("pipeline-config.json").mqtt;
+    std::string broker = argc > 1 ? argv[1] : config.address;
+    double seconds = argc > 2 ? std::stod(argv[2]) : 30.0;
+    double stale_ms = argc > 3 ? std::stod(argv[3]) : 100.0;
+
+    mqtt::async_client client(broker, "latency_probe");
+    try {
+        client.start_consuming();
+        client.connect()->wait();
+        client.subscribe(config.topic, config.qos)->wait();
+        client.subscribe(subscriptionFilter(config.robotTopic), config.qos)->wait();
+    } catch (const mqtt::exception& e) {
+        std::cerr << "[Probe] Cannot subscribe at " << broker << ": " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "[Probe] Listening on " << config.topic << " and " << subscriptionFilter(config.robotTopic)
+              << " for " << seconds << " s." << std::endl;
+
+    Distribution frame_to_publish, publish_to_receive, frame_to_receive;
+    std::map<std::string, TopicState> topics;
+    uint64_t received = 0, undecodable = 0, unstamped = 0, stale = 0, out_of_order = 0;
+    CommandFrame frame;
+
+    auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    while (Clock::now() < end) {
+        mqtt::const_message_ptr message;
+        if (!client.try_consume_message_for(&message, std::chrono::milliseconds(100)) || !message) {
+            continue;
+        }
+        uint64_t now_us = commandTimestampNow();
+        ++received;
+
+        const std::string& payload = message->get_payload();
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(payload.data());
+        bool decoded = !payload.empty() && payload[0] == char(COMMAND_FRAME_VERSION)
+                       ? decodeCommandFrame(bytes, payload.size(), frame)
+                       : commandsFromJson(payload, frame);
+        if (!decoded) {
+            ++undecodable;
+            continue;
+        }
+        const CommandStamp& stamp = frame.stamp;
+        if (stamp.captureTimeUs == 0 || stamp.publishTimeUs == 0) {
+            ++unstamped; // e.g. an older publisher
+            continue;
+        }
+
+        TopicState& topic = topics[message->get_topic()];
+        if (topic.seen && int32_t(stamp.sequence - topic.lastSequence) <= 0) {
+            ++out_of_order;
+        }
+        topic.seen = true;
+        topic.lastSequence = stamp.sequence;
+
+        double age_ms = (double(now_us) - double(stamp.captureTimeUs)) / 1000.0;
+        frame_to_publish.samples.push_back((double(stamp.publishTimeUs) - double(stamp.captureTimeUs)) / 1000.0);
+        publish_to_receive.samples.push_back((double(now_us) - double(stamp.publishTimeUs)) / 1000.0);
+        frame_to_receive.samples.push_back(age_ms);
+        if (age_ms > stale_ms) ++stale;
+    }
+    client.disconnect()->wait();
+
+    std::cout << "Received " << received << " payloads on " << topics.size() << " topics: " << undecodable
+              << " undecodable, " << unstamped << " without a stamp, " << out_of_order << " out of order or repeated, "
+              << stale << " older than " << stale_ms << " ms" << std::endl;
+    frame_to_publish.print("frame -> publish");
+    publish_to_receive.print("publish -> recv");
+    frame_to_receive.print("frame -> recv");
+    return received > 0 ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#include "loopback_transport.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include "pipeline_config.h"
+
+void LoopbackTransport::send(int robotId, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    bool ok = size > 0 && bytes[0] == COMMAND_FRAME_VERSION
+              ? decodeCommandFrame(bytes, size, decoded)
+              : commandsFromJson(std::string(static_cast<const char*>(data), size), decoded);
+    uint64_t now_us = commandTimestampNow();
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++counters.queued;
+        if (!ok) {
+            ++counters.failed;
+            return;
+        }
+        ++counters.sent;
+        counters.wireBytes += size;
+        if (decoded.stamp.captureTimeUs > 0) {
+            double age_ms = (double(now_us) - double(decoded.stamp.captureTimeUs)) / 1000.0;
+            ages.add(float(age_ms));
+            counters.latencyMs = counters.sent > 1 ? 0.9 * counters.latencyMs + 0.1 * age_ms : age_ms;
+            counters.maxLatencyMs = std::max(counters.maxLatencyMs, age_ms);
+        }
+    }
+    if (receiver) {
+        receiver(robotId, decoded);
+    }
+}
+
+void LoopbackTransport::flush() {
+    if (++publishes % STATS_REPORT_STEPS == 0) {
+        std::cout << "[Loopback] " << stats().sent << " payloads, frame -> delivery p50 " << agePercentile(0.5)
+                  << " ms, p99 " << agePercentile(0.99) << " ms" << std::endl;
+    }
+}
+
+PublishStats LoopbackTransport::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return counters;
+}
+
+double LoopbackTransport::agePercentile(double p) const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return ages.percentile(p);
+}
@@ -0,0 +1,44 @@
+#ifndef CAM_ARUCO_LOOPBACK_TRANSPORT_H
+#define CAM_ARUCO_LOOPBACK_TRANSPORT_H
+
+#include <functional>
+#include <mutex>
+#include "command_frame.h"
+#include "command_transport.h"
+#include "rolling_window.h"
+
+// Delivers payloads in-process, on the sending thread: nothing leaves the
+// host and nothing can be lost. Each payload is decoded like a robot would
+// and its age (camera frame capture to delivery) recorded, so the whole
+// pipeline can be run and timed on a laptop with no broker or robots.
+// stats().latencyMs is that age, as delivery itself takes no time.
+class LoopbackTransport : public CommandTransport {
+public:
+    // Called for every payload after it is decoded; frame is valid for the call only
+    using Receiver = std::function<void(int robotId, const CommandFrame& frame)>;
+    static constexpr int AGE_WINDOW = 1024;
+
+    explicit LoopbackTransport(Receiver receiver = nullptr) : receiver(std::move(receiver)) {}
+
+    bool connect() override { return true; }
+    void disconnect() override {}
+    void send(int robotId, const void* data, size_t size) override;
+    // Prints the age percentiles every STATS_REPORT_STEPS publishes
+    void flush() override;
+    PublishStats stats() const override;
+    std::string name() const override { return "loopback"; }
+
+    // Age of the last AGE_WINDOW payloads on arrival, in ms
+    double agePercentile(double p) const;
+
+private:
+    Receiver receiver;
+    CommandFrame decoded; // Reused between payloads
+
+    mutable std::mutex statsMutex;
+    PublishStats counters;
+    RollingWindow<AGE_WINDOW> ages;
+    uint64_t publishes = 0; // flush() calls, one per AI step; caller's thread only
+};
+
+#endif //CAM_ARUCO_LOOPBACK_TRANSPORT_H
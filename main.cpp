@@ -4,12 +4,17 @@
 #include <iostream>
 #include <thread>
 #include "detection_handler.h" // Contains SharedState and loop declarations
+#include "camera_handler.h"
+#include "pipeline_config.h"
 
 using namespace cv;
 using namespace std;
 using json = nlohmann::json;
 
 int main() {
+    // --- 0. Load Pipeline Settings ---
+    PipelineConfig config = loadPipelineConfig("pipeline-config.json");
+
     // --- 1. Load Calibration Data ---
     ifstream file("rpi-camera-calib-params.json");
     if (!file.is_open()) {
@@ -46,20 +51,20 @@ int main() {
     float markerLength = 0.03f; // Example: 3cm markers
 
     // --- 2. Initialize Camera ---
-    VideoCapture cap("/dev/video2", CAP_V4L2);
-    if (!cap.isOpened()) {
-        cerr << "ERROR: Failed to open camera on /dev/video2." << endl;
+    // Streams mmap'd V4L2 buffers, or plays back a raw frame file if the
+    // configured device is a regular file.
+    CameraHandler camera;
+    if (!camera.open(config.camera)) {
+        cerr << "ERROR: Failed to open camera on " << config.camera.device << "." << endl;
         return -1;
     }
-    cap.set(CAP_PROP_FRAME_WIDTH, 860);
-    cap.set(CAP_PROP_FRAME_HEIGHT, 720);
 
     // --- 3. Start Processing Threads ---
     SharedState state; // This object is shared between the two threads
 
     cout << "Starting camera and detection threads..." << endl;
-    thread camThread(captureLoop, std::ref(cap), std::ref(state));
-    thread detectThread(detectionLoop, std::ref(cameraMatrix), std::ref(distCoeffs), markerLength, std::ref(state));
+    thread camThread(captureLoop, std::ref(camera), std::ref(state));
+    thread detectThread(detectionLoop, std::cref(config), std::ref(cameraMatrix), std::ref(distCoeffs), markerLength, std::ref(state));
 
     // --- 4. Wait for Threads to Complete ---
     // The main thread will wait here until the user presses 'q' in the display window.
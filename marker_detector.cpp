@@ -0,0 +1,131 @@
+#include "marker_detector.h"
+#include <algorithm>
+#include "rect_utils.h"
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+Point2f quadCenter(const vector<Point2f>& c) {
+    return (c[0] + c[1] + c[2] + c[3]) / 4;
+}
+
+float quadSide(const vector<Point2f>& c) {
+    float side = 0;
+    for (int i = 0; i < 4; ++i) {
+        side = max(side, static_cast<float>(norm(c[(i + 1) % 4] - c[i])));
+    }
+    return side;
+}
+
+bool isArenaMarker(int id) {
+    return id >= FIRST_ARENA_MARKER_ID && id <= LAST_ARENA_MARKER_ID;
+}
+
+} // namespace
+
+MarkerDetector::MarkerDetector(const MarkerConfig& config)
+    : detector(aruco::getPredefinedDictionary(aruco::DICT_4X4_50)), config(config) {}
+
+void MarkerDetector::detect(const Mat& gray, bool includeArena) {
+    ++framesSinceFullScan;
+    fullScan = !config.tracking || tracks.empty() || framesSinceFullScan >= config.fullScanInterval;
+
+    // A marker missing from its window may just have moved further than
+    // predicted, so fall back to a full scan in the same frame.
+    if (!fullScan && !detectInWindows(gray, includeArena)) {
+        fullScan = true;
+    }
+    if (fullScan) {
+        detectFull(gray);
+        framesSinceFullScan = 0;
+    }
+
+    updateTracks(includeArena);
+
+    arena.clear();
+    bots.clear();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (isArenaMarker(ids[i])) {
+            arena.ids.push_back(ids[i]);
+            arena.corners.push_back(corners[i]);
+        } else if (ids[i] < FIRST_ARENA_MARKER_ID) {
+            bots.ids.push_back(ids[i]);
+            bots.corners.push_back(corners[i]);
+        }
+    }
+}
+
+void MarkerDetector::detectFull(const Mat& gray) {
+    detector.detectMarkers(gray, corners, ids);
+}
+
+// Returns false if any tracked marker was not found in its window.
+bool MarkerDetector::detectInWindows(const Mat& gray, bool includeArena) {
+    const Rect frameRect(0, 0, gray.cols, gray.rows);
+
+    // One window per track around its predicted quad, merged where they overlap
+    // so each marker is searched exactly once.
+    windows.clear();
+    for (const auto& track : tracks) {
+        if (!includeArena && isArenaMarker(track.id)) continue;
+        float pad = quadSide(track.corners) * config.searchMargin;
+        Rect box = boundingRect(track.corners);
+        box.x += cvRound(track.velocity.x) - cvRound(pad);
+        box.y += cvRound(track.velocity.y) - cvRound(pad);
+        box.width += 2 * cvRound(pad);
+        box.height += 2 * cvRound(pad);
+        box &= frameRect;
+        if (box.empty()) return false;
+        windows.push_back(box);
+    }
+    mergeOverlappingRects(windows);
+
+    ids.clear();
+    corners.clear();
+    for (const auto& window : windows) {
+        // gray(window) is a header into the full frame, not a copy
+        detector.detectMarkers(gray(window), roiCorners, roiIds);
+        for (size_t i = 0; i < roiIds.size(); ++i) {
+            if (find(ids.begin(), ids.end(), roiIds[i]) != ids.end()) continue;
+            for (auto& corner : roiCorners[i]) {
+                corner.x += window.x;
+                corner.y += window.y;
+            }
+            ids.push_back(roiIds[i]);
+            corners.push_back(roiCorners[i]);
+        }
+    }
+
+    for (const auto& track : tracks) {
+        if (!includeArena && isArenaMarker(track.id)) continue;
+        if (find(ids.begin(), ids.end(), track.id) == ids.end()) return false;
+    }
+    return true;
+}
+
+void MarkerDetector::updateTracks(bool includeArena) {
+    vector<Track> previous;
+    previous.swap(tracks);
+
+    // Arena markers that were not searched for keep their last track
+    if (!includeArena) {
+        for (const auto& old : previous) {
+            if (isArenaMarker(old.id) && find(ids.begin(), ids.end(), old.id) == ids.end()) {
+                tracks.push_back({old.id, old.corners, Point2f(0, 0)});
+            }
+        }
+    }
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        Point2f velocity(0, 0);
+        for (const auto& old : previous) {
+            if (old.id == ids[i]) {
+                velocity = quadCenter(corners[i]) - quadCenter(old.corners);
+                break;
+            }
+        }
+        tracks.push_back({ids[i], corners[i], velocity});
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef CAM_ARUCO_MARKER_DETECTOR_H
+#define CAM_ARUCO_MARKER_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/aruco.hpp>
+#include <vector>
+#include "pipeline_config.h"
+
+// Arena corner markers are IDs 46-49, every lower ID is a bot.
+constexpr int FIRST_ARENA_MARKER_ID = 46;
+constexpr int LAST_ARENA_MARKER_ID = 49;
+
+struct MarkerDetections {
+    std::vector<int> ids;
+    std::vector<std::vector<cv::Point2f>> corners;
+
+    void clear() {
+        ids.clear();
+        corners.clear();
+    }
+};
+
+// Shared ArUco front-end. The dictionary and detector are built once, and each
+// frame gets a single detection pass whose results are routed to the arena and
+// bot stages.
+//
+// With tracking enabled, markers seen in the previous frame are only searched
+// for inside padded windows around their predicted quads. A full-frame scan
+// runs every fullScanInterval frames (to pick up new markers) and immediately
+// whenever a tracked marker is not found in its window.
+//
+// Passing includeArena = false leaves the arena markers out of the windowed
+// search (used while the arena homography is locked). Their tracks are kept so
+// they can be searched for again later, and a full scan still reports them.
+class MarkerDetector {
+public:
+    explicit MarkerDetector(const MarkerConfig& config);
+
+    // Detects markers in a single-channel image.
+    void detect(const cv::Mat& gray, bool includeArena = true);
+
+    const MarkerDetections& arenaMarkers() const { return arena; }
+    const MarkerDetections& botMarkers() const { return bots; }
+
+    // True if the last detect() had to scan the whole frame.
+    bool lastWasFullScan() const { return fullScan; }
+
+private:
+    struct Track {
+        int id;
+        std::vector<cv::Point2f> corners;
+        cv::Point2f velocity; // Center motion per frame
+    };
+
+    void detectFull(const cv::Mat& gray);
+    bool detectInWindows(const cv::Mat& gray, bool includeArena);
+    void updateTracks(bool includeArena);
+
+    cv::aruco::ArucoDetector detector;
+    MarkerConfig config;
+
+    std::vector<Track> tracks;
+    int framesSinceFullScan = 0;
+    bool fullScan = true;
+
+    // Scratch buffers, reused across frames
+    std::vector<int> ids;
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int> roiIds;
+    std::vector<std::vector<cv::Point2f>> roiCorners;
+    std::vector<cv::Rect> windows;
+
+    MarkerDetections arena;
+    MarkerDetections bots;
+};
+
+#endif //CAM_ARUCO_MARKER_DETECTOR_H
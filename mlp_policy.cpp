@@ -0,0 +1,339 @@
+#include "mlp_policy.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const char BLOB_MAGIC[4] = {'M', 'L', 'P', 'W'};
+constexpr uint8_t BLOB_VERSION = 1;
+
+// ML-Agents names for the policy's parameters
+const char* LAYER0_WEIGHT = "network_body._body_endoder.seq_layers.0.weight";
+const char* LAYER0_BIAS = "network_body._body_endoder.seq_layers.0.bias";
+const char* LAYER1_WEIGHT = "network_body._body_endoder.seq_layers.2.weight";
+const char* LAYER1_BIAS = "network_body._body_endoder.seq_layers.2.bias";
+const char* MU_WEIGHT = "action_model._continuous_distribution.mu.weight";
+const char* MU_BIAS = "action_model._continuous_distribution.mu.bias";
+const char* LOG_SIGMA = "action_model._continuous_distribution.log_sigma";
+
+// The policy clips actions to [-3, 3] and scales them to [-1, 1]
+constexpr float ACTION_CLIP = 3.0f;
+
+// Reads protobuf wire format, which is all that's needed to pull the
+// initializers out of an ONNX file without linking protobuf.
+// Throws std::runtime_error on malformed input.
+struct ProtoReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    bool done() const { return p >= end; }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("truncated varint");
+    }
+
+    void next(uint32_t& field, uint32_t& wire) {
+        uint64_t key = varint();
+        field = uint32_t(key >> 3);
+        wire = uint32_t(key & 0x7);
+    }
+
+    // Length-delimited field (wire type 2)
+    ProtoReader bytes() {
+        uint64_t size = varint();
+        if (size > uint64_t(end - p)) throw std::runtime_error("truncated field");
+        ProtoReader sub{p, p + size};
+        p += size;
+        return sub;
+    }
+
+    std::string string() {
+        ProtoReader s = bytes();
+        return std::string(reinterpret_cast<const char*>(s.p), s.end - s.p);
+    }
+
+    void skip(uint32_t wire) {
+        switch (wire) {
+            case 0: varint(); break;
+            case 1: advance(8); break;
+            case 2: bytes(); break;
+            case 5: advance(4); break;
+            default: throw std::runtime_error("unsupported wire type");
+        }
+    }
+
+    void advance(size_t n) {
+        if (n > size_t(end - p)) throw std::runtime_error("truncated field");
+        p += n;
+    }
+};
+
+struct Tensor {
+    std::vector<int64_t> dims;
+    std::vector<float> data;
+};
+
+// TensorProto: dims = 1, data_type = 2, float_data = 4, name = 8, raw_data = 9
+void parseTensor(ProtoReader r, std::map<std::string, Tensor>& tensors) {
+    Tensor t;
+    std::string name;
+    int32_t data_type = 0;
+    while (!r.done()) {
+        uint32_t field, wire;
+        r.next(field, wire);
+        if (field == 1 && wire == 0) {
+            t.dims.push_back(int64_t(r.varint()));
+        } else if (field == 1 && wire == 2) {
+            for (ProtoReader packed = r.bytes(); !packed.done();) t.dims.push_back(int64_t(packed.varint()));
+        } else if (field == 2 && wire == 0) {
+            data_type = int32_t(r.varint());
+        } else if (field == 4 && wire == 2) {
+            ProtoReader packed = r.bytes();
+            size_t count = (packed.end - packed.p) / sizeof(float);
+            size_t offset = t.data.size();
+            t.data.resize(offset + count);
+            std::memcpy(t.data.data() + offset, packed.p, count * sizeof(float));
+        } else if (field == 4 && wire == 5) {
+            float value;
+            std::memcpy(&value, r.p, sizeof(float));
+            r.advance(sizeof(float));
+            t.data.push_back(value);
+        } else if (field == 8 && wire == 2) {
+            name = r.string();
+        } else if (field == 9 && wire == 2) {
+            ProtoReader raw = r.bytes();
+            t.data.resize((raw.end - raw.p) / sizeof(float));
+            std::memcpy(t.data.data(), raw.p, t.data.size() * sizeof(float));
+        } else {
+            r.skip(wire);
+        }
+    }
+    if (data_type == 1) { // FLOAT; the policy has no other parameter types
+        tensors[name] = std::move(t);
+    }
+}
+
+// Collects the float initializers of the model's graph by name. Identity nodes
+// over an initializer (the exporter emits them for shared weights) add an alias.
+std::map<std::string, Tensor> readInitializers(const std::vector<uint8_t>& file) {
+    std::map<std::string, Tensor> tensors;
+    std::vector<std::pair<std::string, std::string>> identities;
+
+    ProtoReader model{file.data(), file.data() + file.size()};
+    while (!model.done()) {
+        uint32_t field, wire;
+        model.next(field, wire);
+        if (field != 7 || wire != 2) { // ModelProto.graph
+            model.skip(wire);
+            continue;
+        }
+        ProtoReader graph = model.bytes();
+        while (!graph.done()) {
+            graph.next(field, wire);
+            if (field == 5 && wire == 2) { // GraphProto.initializer
+                parseTensor(graph.bytes(), tensors);
+            } else if (field == 1 && wire == 2) { // GraphProto.node
+                ProtoReader node = graph.bytes();
+                std::string input, output, op_type;
+                while (!node.done()) {
+                    node.next(field, wire);
+                    if (field == 1 && wire == 2) input = node.string();
+                    else if (field == 2 && wire == 2) output = node.string();
+                    else if (field == 4 && wire == 2) op_type = node.string();
+                    else node.skip(wire);
+                }
+                if (op_type == "Identity") identities.emplace_back(input, output);
+            } else {
+                graph.skip(wire);
+            }
+        }
+    }
+
+    for (const auto& [input, output] : identities) {
+        auto it = tensors.find(input);
+        if (it != tensors.end()) tensors[output] = it->second;
+    }
+    return tensors;
+}
+
+const Tensor& requireTensor(const std::map<std::string, Tensor>& tensors, const char* name, size_t size) {
+    auto it = tensors.find(name);
+    if (it == tensors.end()) {
+        throw std::runtime_error(std::string("missing initializer ") + name);
+    }
+    if (it->second.data.size() != size) {
+        throw std::runtime_error(std::string("unexpected shape for ") + name);
+    }
+    return it->second;
+}
+
+// In-place Swish, x * sigmoid(x), in the same order of operations as the exported graph
+template <int N>
+void swish(float* x) {
+    for (int i = 0; i < N; ++i) {
+        x[i] = x[i] * (1.0f / (1.0f + std::exp(-x[i])));
+    }
+}
+
+template <int IN, int OUT>
+void writeLayer(std::ofstream& out, const DenseLayer<IN, OUT>& layer) {
+    // Written in ONNX order ([OUT x IN]) so the file doesn't depend on the engine's layout
+    std::vector<float> onnx_weights(IN * OUT);
+    for (int o = 0; o < OUT; ++o) {
+        for (int i = 0; i < IN; ++i) {
+            onnx_weights[o * IN + i] = layer.weights[i * OUT + o];
+        }
+    }
+    out.write(reinterpret_cast<const char*>(onnx_weights.data()), onnx_weights.size() * sizeof(float));
+    out.write(reinterpret_cast<const char*>(layer.bias), OUT * sizeof(float));
+}
+
+template <int IN, int OUT>
+bool readLayer(std::ifstream& in, DenseLayer<IN, OUT>& layer) {
+    std::vector<float> onnx_weights(IN * OUT), bias(OUT);
+    in.read(reinterpret_cast<char*>(onnx_weights.data()), onnx_weights.size() * sizeof(float));
+    in.read(reinterpret_cast<char*>(bias.data()), bias.size() * sizeof(float));
+    if (!in) return false;
+    layer.load(onnx_weights.data(), bias.data());
+    return true;
+}
+
+} // namespace
+
+MlpPolicy::MlpPolicy(bool deterministic, Precision precision)
+    : layer0(), layer1(), mu(), layer0_int8(), layer1_int8(), log_sigma(), sigma(),
+      deterministic(deterministic), precision(precision), rng(std::random_device{}()), noise(0.0f, 1.0f) {}
+
+bool MlpPolicy::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4] = {};
+    in.read(magic, sizeof(magic));
+    if (!in) {
+        std::cerr << "[MLP] Cannot read " << path << std::endl;
+        return false;
+    }
+    bool loaded = std::memcmp(magic, BLOB_MAGIC, sizeof(magic)) == 0 ? loadBlob(path) : loadOnnx(path);
+    if (loaded && precision == Precision::INT8) {
+        layer0_int8.quantize(layer0);
+        layer1_int8.quantize(layer1);
+    }
+    return loaded;
+}
+
+bool MlpPolicy::loadOnnx(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    try {
+        auto tensors = readInitializers(file);
+        const auto& w0 = requireTensor(tensors, LAYER0_WEIGHT, HIDDEN_SIZE * OBSERVATION_SIZE);
+        const auto& b0 = requireTensor(tensors, LAYER0_BIAS, HIDDEN_SIZE);
+        const auto& w1 = requireTensor(tensors, LAYER1_WEIGHT, HIDDEN_SIZE * HIDDEN_SIZE);
+        const auto& b1 = requireTensor(tensors, LAYER1_BIAS, HIDDEN_SIZE);
+        const auto& wm = requireTensor(tensors, MU_WEIGHT, ACTION_SIZE * HIDDEN_SIZE);
+        const auto& bm = requireTensor(tensors, MU_BIAS, ACTION_SIZE);
+        const auto& ls = requireTensor(tensors, LOG_SIGMA, ACTION_SIZE);
+
+        layer0.load(w0.data.data(), b0.data.data());
+        layer1.load(w1.data.data(), b1.data.data());
+        mu.load(wm.data.data(), bm.data.data());
+        for (int a = 0; a < ACTION_SIZE; ++a) {
+            log_sigma[a] = ls.data[a];
+            sigma[a] = std::exp(log_sigma[a]);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[MLP] Cannot load " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MlpPolicy::loadBlob(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    uint8_t version = 0;
+    int32_t shape[4] = {};
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), 1);
+    in.read(reinterpret_cast<char*>(shape), sizeof(shape));
+    if (!in || version != BLOB_VERSION) {
+        std::cerr << "[MLP] Unsupported weights file " << path << std::endl;
+        return false;
+    }
+    if (shape[0] != OBSERVATION_SIZE || shape[1] != HIDDEN_SIZE || shape[2] != HIDDEN_SIZE || shape[3] != ACTION_SIZE) {
+        std::cerr << "[MLP] " << path << " has shape " << shape[0] << "-" << shape[1] << "-" << shape[2] << "-"
+                  << shape[3] << ", expected " << OBSERVATION_SIZE << "-" << HIDDEN_SIZE << "-" << HIDDEN_SIZE
+                  << "-" << ACTION_SIZE << std::endl;
+        return false;
+    }
+    float file_log_sigma[ACTION_SIZE];
+    bool ok = readLayer(in, layer0) && readLayer(in, layer1) && readLayer(in, mu);
+    in.read(reinterpret_cast<char*>(file_log_sigma), sizeof(file_log_sigma));
+    if (!ok || !in) {
+        std::cerr << "[MLP] Truncated weights file " << path << std::endl;
+        return false;
+    }
+    for (int a = 0; a < ACTION_SIZE; ++a) {
+        log_sigma[a] = file_log_sigma[a];
+        sigma[a] = std::exp(log_sigma[a]);
+    }
+    return true;
+}
+
+bool MlpPolicy::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    const int32_t shape[4] = {OBSERVATION_SIZE, HIDDEN_SIZE, HIDDEN_SIZE, ACTION_SIZE};
+    out.write(BLOB_MAGIC, sizeof(BLOB_MAGIC));
+    out.write(reinterpret_cast<const char*>(&BLOB_VERSION), 1);
+    out.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+    writeLayer(out, layer0);
+    writeLayer(out, layer1);
+    writeLayer(out, mu);
+    out.write(reinterpret_cast<const char*>(log_sigma), sizeof(log_sigma));
+    return bool(out);
+}
+
+void MlpPolicy::run(const float* obs, int batch, float* actions) {
+    if (precision == Precision::INT8) {
+        forward(layer0_int8, layer1_int8, obs, batch, actions);
+    } else {
+        forward(layer0, layer1, obs, batch, actions);
+    }
+}
+
+template <typename Layer0, typename Layer1>
+void MlpPolicy::forward(const Layer0& first, const Layer1& second, const float* obs, int batch, float* actions) {
+    alignas(64) float hidden0[HIDDEN_SIZE];
+    alignas(64) float hidden1[HIDDEN_SIZE];
+    float mean[ACTION_SIZE];
+
+    for (int b = 0; b < batch; ++b) {
+        first.forward(obs + b * OBSERVATION_SIZE, hidden0);
+        swish<HIDDEN_SIZE>(hidden0);
+        second.forward(hidden0, hidden1);
+        swish<HIDDEN_SIZE>(hidden1);
+        mu.forward(hidden1, mean);
+
+        float* out = actions + b * ACTION_SIZE;
+        for (int a = 0; a < ACTION_SIZE; ++a) {
+            float action = mean[a];
+            if (!deterministic) {
+                action += noise(rng) * sigma[a];
+            }
+            out[a] = std::clamp(action, -ACTION_CLIP, ACTION_CLIP) / ACTION_CLIP;
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef CAM_ARUCO_MLP_POLICY_H
+#define CAM_ARUCO_MLP_POLICY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include "policy_backend.h"
+
+// Fully connected layer with compile-time shape, y = W x + b.
+// Weights are stored input-major ([IN][OUT], the transpose of ONNX's Gemm
+// layout), so forward() is IN contiguous multiply-adds over OUT floats. That
+// inner loop has no reduction, so the compiler vectorizes it without
+// -ffast-math and the summation order (and result) is the same on every CPU.
+template <int IN, int OUT>
+struct DenseLayer {
+    static constexpr int inputs = IN;
+    static constexpr int outputs = OUT;
+
+    alignas(64) float weights[IN * OUT];
+    alignas(64) float bias[OUT];
+
+    // onnx_weights is [OUT x IN], as stored for a Gemm with transB=1
+    void load(const float* onnx_weights, const float* onnx_bias) {
+        for (int o = 0; o < OUT; ++o) {
+            for (int i = 0; i < IN; ++i) {
+                weights[i * OUT + o] = onnx_weights[o * IN + i];
+            }
+        }
+        std::copy(onnx_bias, onnx_bias + OUT, bias);
+    }
+
+    void forward(const float* __restrict x, float* __restrict y) const {
+        std::copy(bias, bias + OUT, y);
+        for (int i = 0; i < IN; ++i) {
+            const float xi = x[i];
+            const float* __restrict w = weights + i * OUT;
+            for (int o = 0; o < OUT; ++o) {
+                y[o] += xi * w[o];
+            }
+        }
+    }
+};
+
+// INT8 version of DenseLayer. Weights are quantized symmetrically to
+// [-127, 127] with one scale per output; each input vector is quantized the
+// same way on the fly with its own scale (dynamic quantization). Each output
+// is then an integer dot product, rescaled to float once.
+// The quantized values are stored as int16 in output-major order: an int16
+// dot product accumulating into int32 maps onto pmaddwd (SSE2) and smlal
+// (NEON) without any target flags, while int8 lanes would first need widening.
+template <int IN, int OUT>
+struct QuantizedDenseLayer {
+    alignas(64) int16_t weights[OUT * IN]; // [OUT][IN]
+    alignas(64) float scale[OUT];          // Weight scale per output
+    alignas(64) float bias[OUT];
+
+    void quantize(const DenseLayer<IN, OUT>& layer) {
+        for (int o = 0; o < OUT; ++o) {
+            float max_abs = 0.0f;
+            for (int i = 0; i < IN; ++i) max_abs = std::max(max_abs, std::abs(layer.weights[i * OUT + o]));
+            scale[o] = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+            for (int i = 0; i < IN; ++i) {
+                weights[o * IN + i] = static_cast<int16_t>(std::lround(layer.weights[i * OUT + o] / scale[o]));
+            }
+        }
+        std::copy(layer.bias, layer.bias + OUT, bias);
+    }
+
+    void forward(const float* __restrict x, float* __restrict y) const {
+        float max_abs = 0.0f;
+        for (int i = 0; i < IN; ++i) max_abs = std::max(max_abs, std::abs(x[i]));
+        const float x_scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+        const float inv_scale = 1.0f / x_scale;
+
+        alignas(64) int16_t xq[IN];
+        for (int i = 0; i < IN; ++i) {
+            xq[i] = static_cast<int16_t>(x[i] * inv_scale + (x[i] >= 0.0f ? 0.5f : -0.5f));
+        }
+
+        for (int o = 0; o < OUT; ++o) {
+            const int16_t* __restrict w = weights + o * IN;
+            int32_t acc = 0;
+            for (int i = 0; i < IN; ++i) {
+                acc += int32_t(xq[i]) * int32_t(w[i]);
+            }
+            y[o] = bias[o] + static_cast<float>(acc) * (x_scale * scale[o]);
+        }
+    }
+};
+
+// Built-in engine for the ML-Agents soccer policy (22 -> 128 -> 128 -> 2, Swish
+// activations). For a network this small, ONNX Runtime's per-call dispatch
+// costs more than the math, so running it directly is much cheaper.
+class MlpPolicy : public PolicyBackend {
+public:
+    static constexpr int HIDDEN_SIZE = 128;
+
+    // INT8 quantizes the two hidden layers (98% of the weights) when the model
+    // is loaded. The 2-output mu layer stays in float.
+    enum class Precision { FP32, INT8 };
+
+    // deterministic: return the mean action, like the model's
+    // "deterministic_continuous_actions" output. Otherwise sample around it
+    // like "continuous_actions".
+    explicit MlpPolicy(bool deterministic = true, Precision precision = Precision::FP32);
+
+    // Reads the weights from an ONNX model exported by ML-Agents, or from a
+    // blob written by save(). The format is detected from the file contents.
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    void run(const float* obs, int batch, float* actions) override;
+    std::string name() const override { return precision == Precision::INT8 ? "mlp-int8" : "mlp"; }
+
+private:
+    bool loadOnnx(const std::string& path);
+    bool loadBlob(const std::string& path);
+
+    template <typename Layer0, typename Layer1>
+    void forward(const Layer0& first, const Layer1& second, const float* obs, int batch, float* actions);
+
+    // The float layers are always kept; save() writes them
+    DenseLayer<OBSERVATION_SIZE, HIDDEN_SIZE> layer0;
+    DenseLayer<HIDDEN_SIZE, HIDDEN_SIZE> layer1;
+    DenseLayer<HIDDEN_SIZE, ACTION_SIZE> mu;
+    QuantizedDenseLayer<OBSERVATION_SIZE, HIDDEN_SIZE> layer0_int8;
+    QuantizedDenseLayer<HIDDEN_SIZE, HIDDEN_SIZE> layer1_int8;
+    float log_sigma[ACTION_SIZE];
+    float sigma[ACTION_SIZE]; // exp(log_sigma), the sampling noise scale
+
+    bool deterministic;
+    Precision precision;
+    std::mt19937 rng;
+    std::normal_distribution<float> noise;
+};
+
+#endif //CAM_ARUCO_MLP_POLICY_H
@@ -1,11 +1,54 @@
 #include "mqtt_publisher.h"
+#include <algorithm>
 #include <iostream>
 #include "json.hpp"
 using json = nlohmann::json;
 
+// How long the send thread sleeps before re-checking its in-flight publishes,
+// which also bounds how late an acknowledgement is timed
+constexpr std::chrono::milliseconds DELIVERY_POLL(1);
+// ... and how long it sleeps when nothing is in flight; a publish wakes it anyway
+constexpr std::chrono::milliseconds IDLE_POLL(100);
+// A publish that is not acknowledged within this is counted as failed
+constexpr std::chrono::seconds DELIVERY_TIMEOUT(5);
 
-MQTTPublisher::MQTTPublisher(const std::string& address, const std::string& topic)
-    : serverAddress(address), topicName(topic), client(address, "vision_publisher") {}
+
+MQTTPublisher::MQTTPublisher(const MqttConfig& config, bool perRobot)
+    : serverAddress(config.address), topicName(config.topic), robotTopicPattern(config.robotTopic),
+      robotTopics(MAX_ROBOT_TOPICS), qos(std::clamp(config.qos, 0, 2)),
+      queueCapacity(std::max(config.queueCapacity, perRobot ? MAX_ROBOT_TOPICS : 1)),
+      maxInFlight(std::max(config.maxInFlight, 1)), client(config.address, "vision_publisher") {
+    if (config.asyncSend) {
+        sender = std::thread(&MQTTPublisher::sendLoop, this);
+    }
+}
+
+MQTTPublisher::~MQTTPublisher() {
+    stopSender();
+}
+
+size_t MQTTPublisher::wireBytes(size_t topic_size, size_t payload_size, int qos) {
+    // Topic length, topic, packet identifier (QoS 1 and 2 only), payload
+    size_t remaining = 2 + topic_size + (qos > 0 ? 2 : 0) + payload_size;
+    size_t length_bytes = 1;
+    for (size_t rest = remaining >> 7; rest > 0; rest >>= 7) ++length_bytes;
+    // PUBACK for QoS 1; PUBREC, PUBREL and PUBCOMP for QoS 2
+    size_t acks = qos == 1 ? 4 : qos == 2 ? 12 : 0;
+    return 1 + length_bytes + remaining + acks;
+}
+
+const std::string* MQTTPublisher::robotTopic(int id) {
+    if (id < 0 || id >= MAX_ROBOT_TOPICS) {
+        return nullptr;
+    }
+    std::string& topic = robotTopics[id];
+    if (topic.empty()) {
+        topic = robotTopicPattern;
+        size_t at = topic.find("{id}");
+        if (at != std::string::npos) topic.replace(at, 4, std::to_string(id));
+    }
+    return &topic;
+}
 
 bool MQTTPublisher::connect() {
     try {
@@ -19,14 +62,164 @@ bool MQTTPublisher::connect() {
 }
 
 void MQTTPublisher::publish(const std::string& message) {
+    publish(message.data(), message.size());
+}
+
+void MQTTPublisher::publish(const void* data, size_t size) {
+    publishTo(topicName, data, size);
+}
+
+void MQTTPublisher::publishTo(const std::string& topic, const void* data, size_t size, bool wake) {
+    if (sender.joinable()) {
+        enqueue(topic, data, size, wake);
+        return;
+    }
     try {
-        client.publish(topicName, message.c_str(), message.length(), 1, false);
+        client.publish(topic, data, size, qos, false);
     } catch (const mqtt::exception& e) {
         std::cerr << "[MQTT] Publish failed: " << e.what() << std::endl;
     }
 }
 
+void MQTTPublisher::send(int robotId, const void* data, size_t size) {
+    if (robotId == ALL_ROBOTS) {
+        publishTo(topicName, data, size, false);
+        return;
+    }
+    const std::string* topic = robotTopic(robotId);
+    if (!topic) {
+        std::cerr << "[MQTT] No topic for robot ID " << robotId << "." << std::endl;
+        return;
+    }
+    publishTo(*topic, data, size, false);
+}
+
+void MQTTPublisher::flush() {
+    queueReady.notify_one();
+    if (++publishes % STATS_REPORT_STEPS == 0) {
+        PublishStats snapshot = stats();
+        std::cout << "[MQTT] Sent " << snapshot.sent << " of " << snapshot.queued << " payloads ("
+                  << snapshot.superseded << " superseded, " << snapshot.dropped << " dropped, " << snapshot.failed
+                  << " failed), queue max " << snapshot.maxQueueDepth << ", latency ~" << snapshot.latencyMs
+                  << " ms (max " << snapshot.maxLatencyMs << " ms)" << std::endl;
+    }
+}
+
+void MQTTPublisher::enqueue(const std::string& topic, const void* data, size_t size, bool wake) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ++counters.queued;
+        auto same = std::find_if(queue.begin(), queue.end(), [&](const Pending& p) { return p.topic == &topic; });
+        if (same != queue.end()) {
+            // Only the newest commands matter; the topic keeps its place in line
+            same->payload.assign(bytes, bytes + size);
+            same->queued = now;
+            ++counters.superseded;
+        } else {
+            if (queue.size() >= queueCapacity) {
+                spareBuffers.push_back(std::move(queue.front().payload));
+                queue.pop_front();
+                ++counters.dropped;
+            }
+            Pending entry;
+            entry.topic = &topic;
+            if (!spareBuffers.empty()) {
+                entry.payload = std::move(spareBuffers.back());
+                spareBuffers.pop_back();
+            }
+            entry.payload.assign(bytes, bytes + size);
+            entry.queued = now;
+            queue.push_back(std::move(entry));
+        }
+        counters.queueDepth = int(queue.size());
+        counters.maxQueueDepth = std::max(counters.maxQueueDepth, counters.queueDepth);
+    }
+    if (wake) {
+        queueReady.notify_one();
+    }
+}
+
+size_t MQTTPublisher::inFlightFor(const std::string* topic) const {
+    return std::count_if(inFlight.begin(), inFlight.end(), [&](const Delivery& d) { return d.topic == topic; });
+}
+
+void MQTTPublisher::sendLoop() {
+    Pending entry;
+    while (!stopping) {
+        collectDeliveries();
+        {
+            // Topics with maxInFlight unacknowledged publishes are held back
+            // in the queue, not after being taken, so their queued commands
+            // keep being replaced by newer ones while the broker is slow
+            std::unique_lock<std::mutex> lock(queueMutex);
+            auto ready = queue.end();
+            auto poll = inFlight.empty() ? IDLE_POLL : DELIVERY_POLL;
+            bool woken = queueReady.wait_for(lock, poll, [&] {
+                ready = std::find_if(queue.begin(), queue.end(),
+                                     [&](const Pending& p) { return inFlightFor(p.topic) < maxInFlight; });
+                return stopping || ready != queue.end();
+            });
+            if (!woken || stopping) {
+                continue;
+            }
+            // Swap buffers with the queue so neither side allocates
+            entry.topic = ready->topic;
+            entry.payload.swap(ready->payload);
+            entry.queued = ready->queued;
+            spareBuffers.push_back(std::move(ready->payload));
+            queue.erase(ready);
+            counters.queueDepth = int(queue.size());
+        }
+        try {
+            auto token = client.publish(*entry.topic, entry.payload.data(), entry.payload.size(), qos, false);
+            inFlight.push_back({entry.topic, token, entry.queued, wireBytes(entry.topic->size(), entry.payload.size(), qos)});
+        } catch (const mqtt::exception& e) {
+            std::cerr << "[MQTT] Publish failed: " << e.what() << std::endl;
+            std::lock_guard<std::mutex> lock(queueMutex);
+            ++counters.failed;
+        }
+    }
+}
+
+void MQTTPublisher::collectDeliveries() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (auto delivery = inFlight.begin(); delivery != inFlight.end();) {
+        bool complete = delivery->token && delivery->token->is_complete();
+        if (!complete && now - delivery->queued < DELIVERY_TIMEOUT) {
+            ++delivery;
+            continue;
+        }
+        if (complete && delivery->token->get_return_code() == 0) {
+            double ms = std::chrono::duration<double, std::milli>(now - delivery->queued).count();
+            counters.latencyMs = counters.sent > 0 ? 0.9 * counters.latencyMs + 0.1 * ms : ms;
+            counters.maxLatencyMs = std::max(counters.maxLatencyMs, ms);
+            counters.wireBytes += delivery->wireBytes;
+            ++counters.sent;
+        } else {
+            ++counters.failed;
+        }
+        delivery = inFlight.erase(delivery);
+    }
+    counters.inFlight = int(inFlight.size());
+}
+
+PublishStats MQTTPublisher::stats() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return counters;
+}
+
+void MQTTPublisher::stopSender() {
+    if (!sender.joinable()) return;
+    stopping = true;
+    queueReady.notify_all();
+    sender.join();
+}
+
 void MQTTPublisher::disconnect() {
+    stopSender();
     try {
         client.disconnect()->wait();
         std::cout << "[MQTT] Disconnected." << std::endl;
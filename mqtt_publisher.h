@@ -2,22 +2,87 @@
 #define MQTT_PUBLISHER_H
 
 #include <mqtt/async_client.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include "command_transport.h"
+#include "pipeline_config.h"
 #include "json.hpp"
 using json = nlohmann::json;
 
-
-class MQTTPublisher {
+// The MQTT command transport. Shared payloads go to config.topic, a robot's
+// own payloads to config.robotTopic.
+class MQTTPublisher : public CommandTransport {
 public:
-    MQTTPublisher(const std::string& address, const std::string& topic);
-    bool connect();
+    // Robot IDs with a per-robot topic; frames carry IDs as one byte
+    static constexpr int MAX_ROBOT_TOPICS = 256;
+
+    // perRobot: payloads go to every robot's own topic, so the queue needs room for all of them
+    explicit MQTTPublisher(const MqttConfig& config, bool perRobot = false);
+    ~MQTTPublisher() override;
+    bool connect() override;
+    // With config.asyncSend these only queue the payload and never block
     void publish(const std::string& message);
-    void disconnect();
+    void publish(const void* data, size_t size);
+    void disconnect() override;
+
+    // Per-robot payloads of one publish are queued (or sent) back-to-back
+    // without waiting for acknowledgements; flush() wakes the send thread once
+    // and prints the stats every STATS_REPORT_STEPS publishes
+    void send(int robotId, const void* data, size_t size) override;
+    void flush() override;
+    PublishStats stats() const override;
+    std::string name() const override { return "mqtt"; }
+
+    // Size of a PUBLISH packet and its acknowledgements, as MQTT 3.1.1 frames them
+    static size_t wireBytes(size_t topic_size, size_t payload_size, int qos);
 
 private:
+    // Topics are compared by address: they are topicName or robotTopics entries
+    struct Pending {
+        const std::string* topic;
+        std::vector<uint8_t> payload;
+        std::chrono::steady_clock::time_point queued;
+    };
+    struct Delivery {
+        const std::string* topic;
+        mqtt::delivery_token_ptr token;
+        std::chrono::steady_clock::time_point queued;
+        size_t wireBytes;
+    };
+
+    void publishTo(const std::string& topic, const void* data, size_t size, bool wake = true);
+    void enqueue(const std::string& topic, const void* data, size_t size, bool wake);
+    const std::string* robotTopic(int id);
+    size_t inFlightFor(const std::string* topic) const;
+    void sendLoop();
+    void collectDeliveries();
+    void stopSender();
+
     std::string serverAddress;
     std::string topicName;
+    std::string robotTopicPattern;
+    std::vector<std::string> robotTopics; // MAX_ROBOT_TOPICS, built on first use
+    int qos;
+    size_t queueCapacity;
+    size_t maxInFlight;
     mqtt::async_client client;
+
+    // Send queue, oldest first, at most one payload per topic
+    mutable std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<Pending> queue;
+    std::vector<std::vector<uint8_t>> spareBuffers; // Payload buffers of sent entries, for reuse
+    PublishStats counters;
+    std::deque<Delivery> inFlight; // Send thread only, oldest first
+    std::atomic<bool> stopping{false};
+    std::thread sender;
+    uint64_t publishes = 0; // flush() calls, one per AI step; caller's thread only
 };
 
 #endif
@@ -0,0 +1,98 @@
+#include "observation_builder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+double squaredDistance(const cv::Point2f& a, const cv::Point2f& b) {
+    // Same precision as cv::norm of the float difference, which the features used before
+    cv::Point2f d = b - a;
+    return double(d.x) * d.x + double(d.y) * d.y;
+}
+
+// Distance feature and unit direction from `from` to `to`, into out[0..2]
+void writeDirection(const cv::Point2f& from, const cv::Point2f& to, double squared, float* out) {
+    cv::Point2f dir = to - from;
+    float dist = float(std::sqrt(squared));
+    out[0] = dist / ARENA_WIDTH;
+    if (dist > 1e-6) {
+        out[1] = dir.x / dist;
+        out[2] = dir.y / dist;
+    }
+}
+
+} // namespace
+
+void ObservationBuilder::build(const WorldState& world, int bot_count, float* obs,
+                               const int* teams, const cv::Point2f* goals) {
+    const int bots = static_cast<int>(world.bots.size());
+    const int balls = static_cast<int>(world.balls.size());
+    std::fill(obs, obs + bot_count * OBSERVATION_SIZE, 0.0f);
+
+    bot_distances.resize(size_t(bots) * bots);
+    for (int i = 0; i < bots; ++i) {
+        bot_distances[size_t(i) * bots + i] = 0.0;
+        for (int j = i + 1; j < bots; ++j) {
+            double d = squaredDistance(world.bots[i].center, world.bots[j].center);
+            bot_distances[size_t(i) * bots + j] = d;
+            bot_distances[size_t(j) * bots + i] = d;
+        }
+    }
+
+    ball_distances.resize(size_t(bot_count) * balls);
+    for (int i = 0; i < bot_count; ++i) {
+        double* row = ball_distances.data() + size_t(i) * balls;
+        for (int k = 0; k < balls; ++k) {
+            row[k] = squaredDistance(world.bots[i].center, world.balls[k].center);
+        }
+    }
+
+    for (int i = 0; i < bot_count; ++i) {
+        const Bot& bot = world.bots[i];
+        float* o = obs + i * OBSERVATION_SIZE;
+
+        o[0] = bot.center.x / ARENA_WIDTH;
+        o[1] = bot.center.y / ARENA_HEIGHT;
+        float angle_rad = bot.angle * CV_PI / 180.0;
+        o[2] = std::cos(angle_rad);
+        o[3] = std::sin(angle_rad);
+
+        // Nearest other bot of the same team, skipping any with this bot's ID
+        const double* bot_row = bot_distances.data() + size_t(i) * bots;
+        int teammate = -1;
+        double best = std::numeric_limits<double>::max();
+        for (int j = 0; j < bots; ++j) {
+            if (world.bots[j].id == bot.id) continue;
+            if (teams && (teams[j] != teams[i] || teams[i] < 0)) continue;
+            if (bot_row[j] < best) {
+                best = bot_row[j];
+                teammate = j;
+            }
+        }
+        if (teammate >= 0) {
+            writeDirection(bot.center, world.bots[teammate].center, best, o + 4);
+        }
+
+        const cv::Point2f& goal = goals ? goals[i] : OPPONENT_GOAL_POSITION;
+        writeDirection(bot.center, goal, squaredDistance(bot.center, goal), o + 7);
+
+        // The 4 nearest balls, kept sorted by insertion; strict < keeps world order on ties
+        const double* ball_row = ball_distances.data() + size_t(i) * balls;
+        int nearest[NEAREST_BALLS];
+        int found = 0;
+        for (int k = 0; k < balls; ++k) {
+            if (found == NEAREST_BALLS && !(ball_row[k] < ball_row[nearest[found - 1]])) continue;
+            int slot = std::min(found, NEAREST_BALLS - 1);
+            while (slot > 0 && ball_row[k] < ball_row[nearest[slot - 1]]) {
+                nearest[slot] = nearest[slot - 1];
+                --slot;
+            }
+            nearest[slot] = k;
+            found = std::min(found + 1, NEAREST_BALLS);
+        }
+        for (int n = 0; n < found; ++n) {
+            writeDirection(bot.center, world.balls[nearest[n]].center, ball_row[nearest[n]], o + 10 + n * 3);
+        }
+    }
+}
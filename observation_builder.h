@@ -0,0 +1,39 @@
+#ifndef CAM_ARUCO_OBSERVATION_BUILDER_H
+#define CAM_ARUCO_OBSERVATION_BUILDER_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include "arena_geometry.h"
+#include "policy_backend.h"
+#include "world_state.h"
+
+// Writes the 22-feature observation of every bot straight into the policy's
+// [bots x OBSERVATION_SIZE] input:
+//   0-3   own position and heading (cos, sin)
+//   4-6   distance and direction to the nearest other bot
+//   7-9   distance and direction to the opponent goal
+//   10-21 distance and direction to the 4 nearest balls, nearest first
+// Squared bot-bot and bot-ball distances are computed once per world (the
+// bot-bot matrix from its upper triangle), the 4 nearest balls are picked
+// with one insertion pass per bot, and a square root is only taken for the
+// features themselves.
+class ObservationBuilder {
+public:
+    static constexpr int NEAREST_BALLS = 4;
+
+    // Fills obs for the first bot_count bots of world. Neighbours are searched
+    // among all of world's bots and balls. Equally distant balls keep their
+    // world order.
+    // With several teams, teams[i] gives the team of every world bot (only
+    // same-team bots count as teammates, -1 matches no one) and goals[i] the
+    // goal the i-th bot attacks. Without them every bot is on one team
+    // attacking OPPONENT_GOAL_POSITION.
+    void build(const WorldState& world, int bot_count, float* obs,
+               const int* teams = nullptr, const cv::Point2f* goals = nullptr);
+
+private:
+    std::vector<double> bot_distances;  // [bots x bots], squared
+    std::vector<double> ball_distances; // [bot_count x balls], squared
+};
+
+#endif //CAM_ARUCO_OBSERVATION_BUILDER_H
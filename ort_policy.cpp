@@ -0,0 +1,146 @@
+#include "ort_policy.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+GraphOptimizationLevel parseOptimizationLevel(const std::string& name) {
+    if (name == "disable") return ORT_DISABLE_ALL;
+    if (name == "basic") return ORT_ENABLE_BASIC;
+    if (name == "extended") return ORT_ENABLE_EXTENDED;
+    if (name != "all") std::cerr << "[AI] Unknown optimization level '" << name << "', using 'all'." << std::endl;
+    return ORT_ENABLE_ALL;
+}
+
+Ort::SessionOptions makeSessionOptions(const AIConfig& config) {
+    Ort::SessionOptions options;
+    options.DisablePerSessionThreads(); // Threads and spinning come from the shared Env
+    options.SetExecutionMode(config.executionMode == "parallel" ? ORT_PARALLEL : ORT_SEQUENTIAL);
+    options.SetGraphOptimizationLevel(parseOptimizationLevel(config.optimizationLevel));
+    return options;
+}
+
+// Size and mtime of the .onnx a cached graph was built from, kept next to the
+// cache. Comparing mtimes alone misses a model replaced by a rename, which
+// keeps the new file's (possibly older) mtime.
+std::string modelStamp(const std::filesystem::path& model_path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(model_path, ec);
+    if (ec) return {};
+    auto mtime = std::filesystem::last_write_time(model_path, ec);
+    if (ec) return {};
+    return std::to_string(size) + " " + std::to_string(mtime.time_since_epoch().count());
+}
+
+// The process-wide Env, created on first use and kept alive by the sessions using it
+std::shared_ptr<Ort::Env> sharedEnv(const AIConfig& config) {
+    static std::mutex mutex;
+    static std::weak_ptr<Ort::Env> shared;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto env = shared.lock()) {
+        return env;
+    }
+    Ort::ThreadingOptions threading;
+    threading.SetGlobalIntraOpNumThreads(config.intraOpThreads);
+    threading.SetGlobalInterOpNumThreads(config.interOpThreads);
+    threading.SetGlobalSpinControl(config.allowSpinning ? 1 : 0);
+    auto env = std::make_shared<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "RobotSoccerAI");
+    shared = env;
+    return env;
+}
+
+} // namespace
+
+Ort::Session OrtPolicy::createSession(Ort::Env& env, const AIConfig& config) {
+    namespace fs = std::filesystem;
+    auto start = std::chrono::steady_clock::now();
+    fs::path model_path(config.modelPath);
+    fs::path cached_path = fs::path(model_path).replace_extension(".ort");
+    fs::path stamp_path = fs::path(cached_path).concat(".source");
+    std::string stamp = modelStamp(model_path);
+
+    auto report = [&](const std::string& source) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[AI] Model loaded from " << source << " in " << ms << " ms." << std::endl;
+    };
+
+    std::error_code ec;
+    bool cache_fresh = false;
+    if (config.cacheOptimizedModel && !stamp.empty() && fs::exists(cached_path, ec)) {
+        std::ifstream stamp_file(stamp_path);
+        std::string cached_stamp;
+        cache_fresh = std::getline(stamp_file, cached_stamp) && cached_stamp == stamp;
+    }
+    if (cache_fresh) {
+        // The cached graph is already optimized; don't spend startup time on it again.
+        Ort::SessionOptions options = makeSessionOptions(config);
+        options.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
+        try {
+            Ort::Session session(env, cached_path.c_str(), options);
+            report(cached_path.string() + " (cached optimized model)");
+            return session;
+        } catch (const Ort::Exception& e) {
+            // e.g. written by a different ORT version; rebuild it below
+            std::cerr << "[AI] Could not load " << cached_path << ": " << e.what() << std::endl;
+        }
+    }
+
+    Ort::SessionOptions options = makeSessionOptions(config);
+    if (config.cacheOptimizedModel) {
+        // ORT writes the optimized graph while creating the session. Graphs optimized at
+        // "extended"/"all" may contain CPU-specific kernels, so the cache belongs to this machine.
+        // The stamp is written once the cache is complete.
+        fs::remove(stamp_path, ec);
+        options.SetOptimizedModelFilePath(cached_path.c_str());
+        options.AddConfigEntry("session.save_model_format", "ORT");
+    }
+    Ort::Session session(env, model_path.c_str(), options);
+    if (config.cacheOptimizedModel && !stamp.empty()) {
+        std::ofstream(stamp_path) << stamp << "\n";
+    }
+    report(model_path.string());
+    return session;
+}
+
+OrtPolicy::OrtPolicy(const AIConfig& config, int max_batch)
+    : env(sharedEnv(config)),
+      session(createSession(*env, config)),
+      memory_info(Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault)),
+      // The stochastic output samples around the mean action; the deterministic one is the mean itself
+      output_name(config.deterministic ? "deterministic_continuous_actions" : "continuous_actions"),
+      obs_buffer(size_t(max_batch) * OBSERVATION_SIZE, 0.0f),
+      mask_buffer(max_batch, 1.0f),
+      action_buffer(size_t(max_batch) * ACTION_SIZE, 0.0f),
+      bindings(max_batch + 1) {}
+
+OrtPolicy::BatchBinding& OrtPolicy::bindingFor(int batch) {
+    BatchBinding& b = bindings[batch];
+    if (b.bound) {
+        return b;
+    }
+
+    // The tensors are views of the fixed buffers; only their batch dimension differs.
+    const int64_t obs_shape[] = {batch, OBSERVATION_SIZE};
+    const int64_t mask_shape[] = {batch, 1};
+    const int64_t action_shape[] = {batch, ACTION_SIZE};
+    b.obs = Ort::Value::CreateTensor<float>(memory_info, obs_buffer.data(), batch * OBSERVATION_SIZE, obs_shape, 2);
+    b.masks = Ort::Value::CreateTensor<float>(memory_info, mask_buffer.data(), batch, mask_shape, 2);
+    b.actions = Ort::Value::CreateTensor<float>(memory_info, action_buffer.data(), batch * ACTION_SIZE, action_shape, 2);
+
+    b.binding = Ort::IoBinding(session);
+    b.binding.BindInput("obs_0", b.obs);
+    b.binding.BindInput("action_masks", b.masks);
+    b.binding.BindOutput(output_name, b.actions);
+    b.bound = true;
+    return b;
+}
+
+void OrtPolicy::run(const float* obs, int batch, float* actions) {
+    std::copy_n(obs, batch * OBSERVATION_SIZE, obs_buffer.data());
+    session.Run(run_options, bindingFor(batch).binding);
+    std::copy_n(action_buffer.data(), batch * ACTION_SIZE, actions);
+}
@@ -0,0 +1,51 @@
+#ifndef CAM_ARUCO_ORT_POLICY_H
+#define CAM_ARUCO_ORT_POLICY_H
+
+#include <memory>
+#include <vector>
+#include <onnxruntime_cxx_api.h>
+#include "pipeline_config.h"
+#include "policy_backend.h"
+
+// Runs the exported ONNX policy through ONNX Runtime. All OrtPolicy sessions in
+// the process share one Ort::Env and its global intra-/inter-op thread pools,
+// sized by the first AIConfig used, so several models don't each spawn threads.
+class OrtPolicy : public PolicyBackend {
+public:
+    // Loads config.modelPath (or its cached optimized .ort copy) with the
+    // configured session options. Throws Ort::Exception if the model can't be loaded.
+    OrtPolicy(const AIConfig& config, int max_batch);
+
+    // Input and output tensors are bound once per batch size, so steady-state
+    // calls do not allocate. They are views of this object's own buffers (the
+    // copies in and out are a few KB), so a session can be warmed up on one
+    // thread and used from another without rebinding.
+    void run(const float* obs, int batch, float* actions) override;
+    std::string name() const override { return "onnxruntime"; }
+
+private:
+    // Input and output tensors for one batch size, bound to the session once.
+    struct BatchBinding {
+        Ort::Value obs{nullptr};
+        Ort::Value masks{nullptr};
+        Ort::Value actions{nullptr};
+        Ort::IoBinding binding{nullptr};
+        bool bound = false;
+    };
+
+    std::shared_ptr<Ort::Env> env;
+    Ort::Session session;
+    Ort::MemoryInfo memory_info;
+    Ort::RunOptions run_options;
+    const char* output_name;
+
+    std::vector<float> obs_buffer;      // [max_batch x OBSERVATION_SIZE]
+    std::vector<float> mask_buffer;     // [max_batch x 1], always 1
+    std::vector<float> action_buffer;   // [max_batch x ACTION_SIZE]
+    std::vector<BatchBinding> bindings; // Indexed by batch size, built on first use
+
+    static Ort::Session createSession(Ort::Env& env, const AIConfig& config);
+    BatchBinding& bindingFor(int batch);
+};
+
+#endif //CAM_ARUCO_ORT_POLICY_H
@@ -0,0 +1,159 @@
+#include "pipeline_config.h"
+#include <fstream>
+#include <iostream>
+#include "json.hpp"
+using json = nlohmann::json;
+
+namespace {
+
+cv::Scalar scalarValue(const json& j, const char* key, const cv::Scalar& fallback) {
+    if (!j.contains(key)) return fallback;
+    const json& v = j[key];
+    return cv::Scalar(v[0].get<double>(), v[1].get<double>(), v[2].get<double>());
+}
+
+} // namespace
+
+PipelineConfig loadPipelineConfig(const std::string& path) {
+    PipelineConfig config;
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "[Config] '" << path << "' not found, using defaults." << std::endl;
+        return config;
+    }
+
+    json j;
+    try {
+        file >> j;
+    } catch (const json::parse_error& e) {
+        std::cerr << "[Config] Failed to parse '" << path << "': " << e.what() << ". Using defaults." << std::endl;
+        return config;
+    }
+
+    if (j.contains("camera")) {
+        const json& c = j["camera"];
+        CameraConfig& camera = config.camera;
+        camera.device = c.value("device", camera.device);
+        camera.width = c.value("width", camera.width);
+        camera.height = c.value("height", camera.height);
+        camera.pixelFormat = c.value("pixel_format", camera.pixelFormat);
+        camera.fileFps = c.value("file_fps", camera.fileFps);
+    }
+
+    if (j.contains("markers")) {
+        const json& m = j["markers"];
+        MarkerConfig& markers = config.markers;
+        markers.tracking = m.value("tracking", markers.tracking);
+        markers.fullScanInterval = m.value("full_scan_interval", markers.fullScanInterval);
+        markers.searchMargin = m.value("search_margin", markers.searchMargin);
+    }
+
+    if (j.contains("arena")) {
+        const json& a = j["arena"];
+        ArenaConfig& arena = config.arena;
+        arena.lock = a.value("lock", arena.lock);
+        arena.lockFrames = a.value("lock_frames", arena.lockFrames);
+        arena.verifyInterval = a.value("verify_interval", arena.verifyInterval);
+        arena.maxDriftPx = a.value("max_drift_px", arena.maxDriftPx);
+    }
+
+    if (j.contains("balls")) {
+        const json& b = j["balls"];
+        BallConfig& balls = config.balls;
+        balls.lutPath = b.value("lut_path", balls.lutPath);
+        balls.lutBits = b.value("lut_bits", balls.lutBits);
+        if (balls.lutBits < 1 || balls.lutBits > 8) {
+            // The LUT shifts each 8-bit channel right by 8 - bits and holds 2^(3 * bits) bins
+            std::cerr << "[Config] balls.lut_bits must be 1-8, not " << balls.lutBits << ". Using "
+                      << BallConfig().lutBits << "." << std::endl;
+            balls.lutBits = BallConfig().lutBits;
+        }
+        balls.lowerHSV = scalarValue(b, "lower_hsv", balls.lowerHSV);
+        balls.upperHSV = scalarValue(b, "upper_hsv", balls.upperHSV);
+        balls.minArea = b.value("min_area", balls.minArea);
+        balls.minCircularity = b.value("min_circularity", balls.minCircularity);
+    }
+
+    if (j.contains("ball_tracker")) {
+        const json& t = j["ball_tracker"];
+        BallTrackerConfig& tracker = config.ballTracker;
+        tracker.tracking = t.value("tracking", tracker.tracking);
+        tracker.fullScanInterval = t.value("full_scan_interval", tracker.fullScanInterval);
+        tracker.searchMargin = t.value("search_margin", tracker.searchMargin);
+        tracker.gateDistance = t.value("gate_distance", tracker.gateDistance);
+        tracker.confirmFrames = t.value("confirm_frames", tracker.confirmFrames);
+        tracker.maxMissedFrames = t.value("max_missed_frames", tracker.maxMissedFrames);
+        tracker.processNoise = t.value("process_noise", tracker.processNoise);
+        tracker.measurementNoise = t.value("measurement_noise", tracker.measurementNoise);
+    }
+
+    if (j.contains("ai")) {
+        const json& a = j["ai"];
+        AIConfig& ai = config.ai;
+        ai.modelPath = a.value("model_path", ai.modelPath);
+        if (a.contains("policies")) {
+            ai.policies.clear();
+            for (const json& p : a["policies"]) {
+                PolicyConfig policy;
+                policy.team = p.value("team", policy.team);
+                policy.modelPath = p.value("model_path", ai.modelPath);
+                policy.botIds = p.value("bot_ids", policy.botIds);
+                if (p.contains("opponent_goal")) {
+                    policy.opponentGoal = {p["opponent_goal"].at(0).get<float>(), p["opponent_goal"].at(1).get<float>()};
+                }
+                ai.policies.push_back(policy);
+            }
+        }
+        ai.backend = a.value("backend", ai.backend);
+        ai.deterministic = a.value("deterministic", ai.deterministic);
+        ai.precision = a.value("precision", ai.precision);
+        ai.recordPath = a.value("record_path", ai.recordPath);
+        ai.changeEpsilon = a.value("change_epsilon", ai.changeEpsilon);
+        ai.traceLevel = a.value("trace_level", ai.traceLevel);
+        ai.tracePath = a.value("trace_path", ai.tracePath);
+        ai.traceCapacity = a.value("trace_capacity", ai.traceCapacity);
+        ai.intraOpThreads = a.value("intra_op_threads", ai.intraOpThreads);
+        ai.interOpThreads = a.value("inter_op_threads", ai.interOpThreads);
+        ai.executionMode = a.value("execution_mode", ai.executionMode);
+        ai.optimizationLevel = a.value("optimization_level", ai.optimizationLevel);
+        ai.allowSpinning = a.value("allow_spinning", ai.allowSpinning);
+        ai.cacheOptimizedModel = a.value("cache_optimized_model", ai.cacheOptimizedModel);
+        ai.watchModel = a.value("watch_model", ai.watchModel);
+        ai.async = a.value("async", ai.async);
+        ai.rateHz = a.value("rate_hz", ai.rateHz);
+    }
+
+    if (j.contains("commands")) {
+        const json& c = j["commands"];
+        CommandsConfig& commands = config.commands;
+        commands.transport = c.value("transport", commands.transport);
+        commands.format = c.value("format", commands.format);
+        commands.layout = c.value("layout", commands.layout);
+    }
+
+    if (j.contains("mqtt")) {
+        const json& m = j["mqtt"];
+        MqttConfig& mqtt = config.mqtt;
+        mqtt.address = m.value("address", mqtt.address);
+        mqtt.topic = m.value("topic", mqtt.topic);
+        mqtt.robotTopic = m.value("robot_topic", mqtt.robotTopic);
+        mqtt.qos = m.value("qos", mqtt.qos);
+        mqtt.asyncSend = m.value("async_send", mqtt.asyncSend);
+        mqtt.queueCapacity = m.value("queue_capacity", mqtt.queueCapacity);
+        mqtt.maxInFlight = m.value("max_in_flight", mqtt.maxInFlight);
+    }
+
+    if (j.contains("udp")) {
+        const json& u = j["udp"];
+        UdpConfig& udp = config.udp;
+        udp.address = u.value("address", udp.address);
+        udp.port = u.value("port", udp.port);
+        udp.robotPortBase = u.value("robot_port_base", udp.robotPortBase);
+        udp.multicastTtl = u.value("multicast_ttl", udp.multicastTtl);
+        udp.multicastInterface = u.value("multicast_interface", udp.multicastInterface);
+    }
+
+    std::cout << "[Config] Loaded settings from " << path << std::endl;
+    return config;
+}
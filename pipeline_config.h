@@ -0,0 +1,181 @@
+#ifndef CAM_ARUCO_PIPELINE_CONFIG_H
+#define CAM_ARUCO_PIPELINE_CONFIG_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "arena_geometry.h"
+
+struct CameraConfig {
+    // A V4L2 device node, or a raw frame dump used as a stand-in camera
+    std::string device = "/dev/video2";
+    int width = 860;
+    int height = 720;
+    std::string pixelFormat = "YUYV"; // "YUYV", "NV12" or "BGR3"
+    double fileFps = 30.0;            // Playback rate when device is a file
+};
+
+struct MarkerConfig {
+    // Search only windows around each marker's predicted position, with a
+    // full-frame scan every fullScanInterval frames or whenever one goes missing.
+    bool tracking = true;
+    int fullScanInterval = 15;
+    float searchMargin = 1.0f; // Window padding around a marker, in marker side lengths
+};
+
+struct ArenaConfig {
+    // Freeze the homography once the arena corners have been seen in
+    // lockFrames frames, re-checking corner drift every verifyInterval frames.
+    bool lock = true;
+    int lockFrames = 30;
+    int verifyInterval = 300;
+    float maxDriftPx = 3.0f;
+};
+
+struct BallConfig {
+    // Colour LUT exported by hsv_tuner. If missing, one is built from the HSV bounds.
+    std::string lutPath = "ball-lut.bin";
+    int lutBits = 5; // Bits per BGR channel when building, 1-8: 5 -> 32^3 bins, 6 -> 64^3
+    cv::Scalar lowerHSV = cv::Scalar(0, 119, 210);
+    cv::Scalar upperHSV = cv::Scalar(51, 196, 255);
+    float minArea = 100.0f;      // Pixels
+    float minCircularity = 0.8f; // Moment-based; 1 is a perfect disc, a 2:1 ellipse scores 0.8
+};
+
+struct BallTrackerConfig {
+    // Between full scans, only windows around the predicted balls are searched.
+    // A full scan runs every fullScanInterval frames or after a ball is missed.
+    bool tracking = true;
+    int fullScanInterval = 10;
+    float searchMargin = 30.0f;     // Window padding beyond the ball radius, px
+    float gateDistance = 60.0f;     // Max distance between prediction and detection, px
+    int confirmFrames = 2;          // Detections before a track is reported
+    int maxMissedFrames = 5;        // Frames a track coasts on its prediction
+    float processNoise = 500.0f;    // Kalman process noise per second
+    float measurementNoise = 4.0f;  // Kalman measurement noise, px^2
+};
+
+// One policy model and the bots it drives
+struct PolicyConfig {
+    std::string team = "A";
+    std::string modelPath;
+    std::vector<int> botIds;                // Empty: every bot no other policy lists
+    cv::Point2f opponentGoal = OPPONENT_GOAL_POSITION; // Goal this team attacks, in top-down pixels
+};
+
+struct AIConfig {
+    std::string modelPath = "RobotSoccerTeamA.onnx";
+
+    // Several models, e.g. one per team for scrimmages. Empty means modelPath
+    // drives every bot. The settings below apply to every policy.
+    std::vector<PolicyConfig> policies;
+
+    // "onnxruntime", or "mlp" for the built-in engine, which reads the same
+    // .onnx file (or a weights blob exported by policy_bench)
+    std::string backend = "onnxruntime";
+    // Drive with the policy's mean action instead of sampling around it
+    bool deterministic = false;
+    // "fp32" or "int8". int8 quantizes the "mlp" backend's weights at startup;
+    // for "onnxruntime", point modelPath at a quantized .onnx instead.
+    std::string precision = "fp32";
+    // Appends every WorldState given to the policy to this file as JSON lines,
+    // for replay with policy_bench. Empty disables recording.
+    std::string recordPath;
+
+    // Skip inference and resend the previous commands when the same bots are
+    // seen and no observation feature moved by more than this (features are
+    // normalized; 1e-3 is about half a pixel). 0 disables the check.
+    float changeEpsilon = 1e-3f;
+
+    // Policy trace: 0 off, 1 record observations/actions to the ring file,
+    // 2 also print them. Cycled at runtime with 'v'; decode with trace_dump.
+    int traceLevel = 1;
+    std::string tracePath = "policy-trace.bin";
+    int traceCapacity = 65536; // Records (one per bot per step, 120 bytes each)
+
+    // ONNX Runtime session options. The policy is tiny, so one thread each
+    // (and no spinning) keeps ORT off the cores the camera and vision use.
+    int intraOpThreads = 1;                   // 0 lets ORT pick one per core
+    int interOpThreads = 1;
+    std::string executionMode = "sequential"; // "sequential" or "parallel"
+    std::string optimizationLevel = "all";    // "disable", "basic", "extended" or "all"
+    bool allowSpinning = false;
+
+    // Save the optimized graph as <model>.ort on first start and load that on
+    // later starts, as long as the .onnx file's size and mtime still match
+    // those recorded in <model>.ort.source. Reloads neither read nor write it.
+    bool cacheOptimizedModel = true;
+
+    // Reload the model, without stopping the pipeline, when modelPath changes
+    // on disk. Replace the file with a rename so it's never read half-written.
+    // 'm' reloads it by hand.
+    bool watchModel = true;
+
+    // Run inference and publishing on their own thread, fed the latest world
+    // state, instead of inline in the detection loop.
+    bool async = true;
+    double rateHz = 10.0; // Commands per second, in either mode
+};
+
+// Stats (change gate, policy latency, command transports) are printed every
+// this many AI steps: a minute at the default ai.rate_hz of 10
+constexpr uint64_t STATS_REPORT_STEPS = 600;
+
+struct CommandsConfig {
+    // How commands reach the robots: "mqtt" through the broker, "udp"
+    // datagrams (unicast or multicast, no broker in between), or "loopback",
+    // which delivers them in-process and reports their age, to run and
+    // benchmark the pipeline without robots or a broker.
+    std::string transport = "mqtt";
+    // Payload: "json", or "binary" for the fixed-layout frame in command_frame.h
+    std::string format = "json";
+    // "shared": every robot's commands in one payload. "per_robot": one small
+    // payload per robot (its own MQTT topic or UDP port), so each robot only
+    // receives and parses its own commands.
+    std::string layout = "shared";
+};
+
+struct MqttConfig {
+    std::string address = "tcp://192.168.0.122:1883";
+    std::string topic = "robots/commands";
+    std::string robotTopic = "robots/{id}/cmd"; // Per-robot layout; {id} is replaced by the robot's ID
+    int qos = 1;
+
+    // Publish from a send thread instead of the caller's. Its queue holds only
+    // the newest payload per topic, so commands that wait out a broker or
+    // Wi-Fi stall are replaced rather than delivered late.
+    bool asyncSend = true;
+    int queueCapacity = 4; // Topics waiting to be sent; when full the oldest is dropped. "per_robot" has room for every robot.
+    int maxInFlight = 2;   // Unacknowledged publishes per topic before the send thread holds it back
+};
+
+struct UdpConfig {
+    // IPv4 unicast address of one receiver, or a multicast group (224.0.0.0/4)
+    // that every robot joins
+    std::string address = "239.255.0.1";
+    int port = 5005;          // Shared layout
+    int robotPortBase = 5100; // Per-robot layout: robot N listens on robotPortBase + N
+    int multicastTtl = 1;     // Hops; 1 keeps datagrams on the local network
+    std::string multicastInterface; // Local IPv4 address to send multicast from; empty lets the kernel pick
+};
+
+// Runtime settings for the whole pipeline. Every field has a default, so the
+// config file only needs to list the values being changed.
+struct PipelineConfig {
+    CameraConfig camera;
+    MarkerConfig markers;
+    ArenaConfig arena;
+    BallConfig balls;
+    BallTrackerConfig ballTracker;
+    AIConfig ai;
+    CommandsConfig commands;
+    MqttConfig mqtt;
+    UdpConfig udp;
+};
+
+// Loads pipeline-config.json style settings. Falls back to defaults (and says
+// so) if the file is missing or cannot be parsed.
+PipelineConfig loadPipelineConfig(const std::string& path);
+
+#endif //CAM_ARUCO_PIPELINE_CONFIG_H
@@ -0,0 +1,25 @@
+#ifndef CAM_ARUCO_POLICY_BACKEND_H
+#define CAM_ARUCO_POLICY_BACKEND_H
+
+#include <string>
+
+// Shape of the soccer policy: 22 observation features in, forward/steer out
+constexpr int OBSERVATION_SIZE = 22;
+constexpr int ACTION_SIZE = 2;
+
+// Runs the policy network on a batch of observations. AIHandler builds the
+// observations and turns actions into motor commands; a backend only does
+// the math, so ONNX Runtime and the built-in engine are interchangeable.
+class PolicyBackend {
+public:
+    virtual ~PolicyBackend() = default;
+
+    // obs is [batch x OBSERVATION_SIZE] and actions receives [batch x ACTION_SIZE],
+    // each in [-1, 1]. A backend is used by one thread at a time, but not
+    // necessarily the thread that created it.
+    virtual void run(const float* obs, int batch, float* actions) = 0;
+
+    virtual std::string name() const = 0;
+};
+
+#endif //CAM_ARUCO_POLICY_BACKEND_H
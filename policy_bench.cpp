@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "ai_handler.h"
+#include "mlp_policy.h"
+#include "observation_builder.h"
+#include "ort_policy.h"
+#include "pipeline_config.h"
+#include "world_state.h"
+
+// Compares the built-in MLP engine against ONNX Runtime.
+//
+// Usage:
+//   policy_bench check   [model.onnx] [samples] [tolerance]  accuracy against ORT, exits 1 on failure
+//   policy_bench latency [model.onnx] [iterations]           per-call latency of both backends
+//   policy_bench export  [model.onnx] [out.mlpw]             write the weights blob for ai.backend "mlp"
+//   policy_bench replay  <worlds.jsonl> [model.onnx]        FP32 vs INT8 on world states recorded
+//                                                           with ai.record_path
+//   policy_bench observations [iterations]                  batched observation builder vs per-bot
+//
+// All backends use the deterministic (mean) action so their outputs can be
+// compared; session options come from pipeline-config.json.
+
+namespace {
+
+constexpr int BATCH_SIZES[] = {1, 2, 6, 12, AIHandler::MAX_BOTS};
+
+AIConfig benchConfig(const std::string& model_path) {
+    AIConfig config = loadPipelineConfig("pipeline-config.json").ai;
+    config.modelPath = model_path;
+    config.deterministic = true;
+    config.changeEpsilon = 0.0f; // Time every step's inference
+    config.watchModel = false;
+    return config;
+}
+
+// Uniform in [-1, 1], roughly the range of every observation feature
+void randomObservations(std::mt19937& rng, std::vector<float>& obs) {
+    std::uniform_real_distribution<float> feature(-1.0f, 1.0f);
+    for (float& value : obs) value = feature(rng);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t index = std::min(sorted.size() - 1, size_t(p * sorted.size()));
+    return sorted[index];
+}
+
+int check(const std::string& model_path, int samples, double tolerance) {
+    AIConfig config = benchConfig(model_path);
+    OrtPolicy ort(config, AIHandler::MAX_BOTS);
+    MlpPolicy mlp(true);
+    if (!mlp.load(model_path)) return 1;
+
+    std::mt19937 rng(1234);
+    std::vector<float> obs(AIHandler::MAX_BOTS * OBSERVATION_SIZE);
+    std::vector<float> expected(AIHandler::MAX_BOTS * ACTION_SIZE), actual(expected.size());
+
+    double max_error = 0.0, total_error = 0.0;
+    long compared = 0, identical = 0;
+    for (int done = 0; done < samples;) {
+        // Cycle through batch sizes so every ORT binding is exercised
+        int batch = std::min(samples - done, 1 + done % AIHandler::MAX_BOTS);
+        randomObservations(rng, obs);
+        ort.run(obs.data(), batch, expected.data());
+        mlp.run(obs.data(), batch, actual.data());
+
+        for (int i = 0; i < batch * ACTION_SIZE; ++i) {
+            double error = std::abs(double(expected[i]) - actual[i]);
+            max_error = std::max(max_error, error);
+            total_error += error;
+            identical += expected[i] == actual[i];
+            ++compared;
+        }
+        done += batch;
+    }
+
+    bool pass = max_error <= tolerance;
+    std::cout << std::scientific << std::setprecision(3)
+              << "Compared " << compared << " actions from " << samples << " observations\n"
+              << "  bit-identical: " << identical << " (" << std::fixed << std::setprecision(1)
+              << 100.0 * identical / compared << "%)\n" << std::scientific << std::setprecision(3)
+              << "  max abs error: " << max_error << "\n"
+              << "  mean abs error: " << total_error / compared << "\n"
+              << (pass ? "PASS" : "FAIL") << " (tolerance " << tolerance << ")" << std::endl;
+    return pass ? 0 : 1;
+}
+
+void timeBackend(PolicyBackend& policy, int batch, int iterations, const std::vector<float>& obs, std::vector<float>& actions) {
+    using Clock = std::chrono::steady_clock;
+    for (int i = 0; i < 100; ++i) policy.run(obs.data(), batch, actions.data()); // Warm-up
+
+    std::vector<double> micros(iterations);
+    for (double& us : micros) {
+        auto start = Clock::now();
+        policy.run(obs.data(), batch, actions.data());
+        us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+    std::sort(micros.begin(), micros.end());
+    double mean = 0.0;
+    for (double us : micros) mean += us;
+    mean /= iterations;
+
+    std::cout << std::left << std::setw(12) << policy.name() << std::right << std::setw(6) << batch
+              << std::fixed << std::setprecision(2)
+              << std::setw(10) << percentile(micros, 0.5) << std::setw(10) << percentile(micros, 0.99)
+              << std::setw(10) << mean << std::endl;
+}
+
+int latency(const std::string& model_path, int iterations) {
+    AIConfig config = benchConfig(model_path);
+    OrtPolicy ort(config, AIHandler::MAX_BOTS);
+    MlpPolicy mlp(true);
+    MlpPolicy mlp_int8(true, MlpPolicy::Precision::INT8);
+    if (!mlp.load(model_path) || !mlp_int8.load(model_path)) return 1;
+
+    std::mt19937 rng(1234);
+    std::vector<float> obs(AIHandler::MAX_BOTS * OBSERVATION_SIZE);
+    std::vector<float> actions(AIHandler::MAX_BOTS * ACTION_SIZE);
+    randomObservations(rng, obs);
+
+    std::cout << "backend      batch   p50(us)   p99(us)  mean(us)" << std::endl;
+    for (int batch : BATCH_SIZES) {
+        timeBackend(ort, batch, iterations, obs, actions);
+        timeBackend(mlp, batch, iterations, obs, actions);
+        timeBackend(mlp_int8, batch, iterations, obs, actions);
+    }
+    return 0;
+}
+
+// Runs every recorded world through AIHandler with each backend/precision and
+// compares the motor commands with the ONNX Runtime FP32 ones.
+int replay(const std::string& log_path, const std::string& model_path) {
+    std::vector<WorldState> worlds;
+    std::ifstream log(log_path);
+    for (std::string line; std::getline(log, line);) {
+        if (line.empty()) continue;
+        try {
+            worlds.push_back(json::parse(line).get<WorldState>());
+        } catch (const json::exception& e) {
+            std::cerr << "Skipping bad line " << worlds.size() + 1 << ": " << e.what() << std::endl;
+        }
+    }
+    if (worlds.empty()) {
+        std::cerr << "No world states in " << log_path << std::endl;
+        return 1;
+    }
+
+    struct Variant {
+        const char* backend;
+        const char* precision;
+        std::vector<double> micros;
+        std::vector<std::vector<BotCommand>> commands;
+    };
+    std::vector<Variant> variants = {{"onnxruntime", "fp32"}, {"mlp", "fp32"}, {"mlp", "int8"}};
+
+    for (Variant& variant : variants) {
+        AIConfig config = benchConfig(model_path);
+        config.backend = variant.backend;
+        config.precision = variant.precision;
+        config.recordPath.clear();
+        config.tracePath.clear();
+        config.traceLevel = TraceRing::OFF;
+        AIHandler ai(config);
+
+        for (const WorldState& world : worlds) {
+            auto start = std::chrono::steady_clock::now();
+            const auto& commands = ai.predictMovements(world);
+            variant.micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            variant.commands.push_back(commands);
+        }
+        std::sort(variant.micros.begin(), variant.micros.end());
+    }
+
+    std::cout << "Replayed " << worlds.size() << " world states; deviation is |left/right| against "
+              << variants[0].backend << " " << variants[0].precision << "\n"
+              << "backend      precision   p50(us)   p90(us)   p99(us)   max dev  mean dev" << std::endl;
+    for (const Variant& variant : variants) {
+        double max_dev = 0.0, total_dev = 0.0;
+        long count = 0;
+        for (size_t w = 0; w < worlds.size(); ++w) {
+            const auto& expected = variants[0].commands[w];
+            const auto& actual = variant.commands[w];
+            for (size_t b = 0; b < std::min(expected.size(), actual.size()); ++b) {
+                for (double dev : {std::abs(expected[b].cmd.left - actual[b].cmd.left),
+                                   std::abs(expected[b].cmd.right - actual[b].cmd.right)}) {
+                    max_dev = std::max(max_dev, dev);
+                    total_dev += dev;
+                    ++count;
+                }
+            }
+        }
+        std::cout << std::left << std::setw(13) << variant.backend << std::setw(9) << variant.precision << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(10) << percentile(variant.micros, 0.5) << std::setw(10) << percentile(variant.micros, 0.9)
+                  << std::setw(10) << percentile(variant.micros, 0.99) << std::setprecision(5)
+                  << std::setw(10) << max_dev << std::setw(10) << (count ? total_dev / count : 0.0) << std::endl;
+    }
+    return 0;
+}
+
+// The per-bot observation builder AIHandler used before ObservationBuilder:
+// every bot scans all bots and fully sorts a copy of the balls.
+void perBotObservation(const Bot& current_bot, const WorldState& world, std::vector<Ball>& sorted_balls, float* obs) {
+    std::fill(obs, obs + OBSERVATION_SIZE, 0.0f);
+
+    obs[0] = current_bot.center.x / ARENA_WIDTH;
+    obs[1] = current_bot.center.y / ARENA_HEIGHT;
+    float angle_rad = current_bot.angle * CV_PI / 180.0;
+    obs[2] = std::cos(angle_rad);
+    obs[3] = std::sin(angle_rad);
+
+    const Bot* teammate = nullptr;
+    float min_teammate_dist = std::numeric_limits<float>::max();
+    for (const auto& other_bot : world.bots) {
+        if (other_bot.id == current_bot.id) continue;
+        float dist = cv::norm(current_bot.center - other_bot.center);
+        if (dist < min_teammate_dist) {
+            min_teammate_dist = dist;
+            teammate = &other_bot;
+        }
+    }
+    if (teammate) {
+        cv::Point2f dir_to_teammate = teammate->center - current_bot.center;
+        float dist_to_teammate = cv::norm(dir_to_teammate);
+        obs[4] = dist_to_teammate / ARENA_WIDTH;
+        if (dist_to_teammate > 1e-6) {
+            obs[5] = dir_to_teammate.x / dist_to_teammate;
+            obs[6] = dir_to_teammate.y / dist_to_teammate;
+        }
+    }
+
+    cv::Point2f dir_to_goal = OPPONENT_GOAL_POSITION - current_bot.center;
+    float dist_to_goal = cv::norm(dir_to_goal);
+    obs[7] = dist_to_goal / ARENA_WIDTH;
+    if (dist_to_goal > 1e-6) {
+        obs[8] = dir_to_goal.x / dist_to_goal;
+        obs[9] = dir_to_goal.y / dist_to_goal;
+    }
+
+    sorted_balls.assign(world.balls.begin(), world.balls.end());
+    std::sort(sorted_balls.begin(), sorted_balls.end(), [&](const Ball& a, const Ball& b) {
+        return cv::norm(a.center - current_bot.center) < cv::norm(b.center - current_bot.center);
+    });
+    for (int i = 0; i < 4 && i < int(sorted_balls.size()); ++i) {
+        int base_idx = 10 + i * 3;
+        cv::Point2f dir_to_ball = sorted_balls[i].center - current_bot.center;
+        float dist_to_ball = cv::norm(dir_to_ball);
+        obs[base_idx] = dist_to_ball / ARENA_WIDTH;
+        if (dist_to_ball > 1e-6) {
+            obs[base_idx + 1] = dir_to_ball.x / dist_to_ball;
+            obs[base_idx + 2] = dir_to_ball.y / dist_to_ball;
+        }
+    }
+}
+
+WorldState randomWorld(std::mt19937& rng, int bots, int balls) {
+    std::uniform_real_distribution<float> position(0.0f, float(ARENA_WIDTH));
+    std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+    WorldState world;
+    for (int i = 0; i < bots; ++i) world.bots.push_back({i, {position(rng), position(rng)}, angle(rng), true});
+    for (int i = 0; i < balls; ++i) world.balls.push_back({{position(rng), position(rng)}, 10.0f, i});
+    return world;
+}
+
+int observations(int iterations) {
+    using Clock = std::chrono::steady_clock;
+    std::mt19937 rng(1234);
+    ObservationBuilder builder;
+    std::vector<Ball> sorted_balls;
+    std::vector<float> expected(AIHandler::MAX_BOTS * OBSERVATION_SIZE), actual(expected.size());
+    bool all_match = true;
+
+    std::cout << " bots  balls  per-bot(us)  batched(us)  speedup  max diff" << std::endl;
+    for (int bots : {2, 6, 12, 20}) {
+        for (int balls : {1, 5, 10, 25, 50}) {
+            WorldState world = randomWorld(rng, bots, balls);
+
+            auto start = Clock::now();
+            for (int it = 0; it < iterations; ++it) {
+                for (int b = 0; b < bots; ++b) {
+                    perBotObservation(world.bots[b], world, sorted_balls, expected.data() + b * OBSERVATION_SIZE);
+                }
+            }
+            double per_bot = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+            start = Clock::now();
+            for (int it = 0; it < iterations; ++it) {
+                builder.build(world, bots, actual.data());
+            }
+            double batched = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+            float max_diff = 0.0f;
+            for (int i = 0; i < bots * OBSERVATION_SIZE; ++i) max_diff = std::max(max_diff, std::abs(expected[i] - actual[i]));
+            all_match = all_match && max_diff == 0.0f;
+
+            std::cout << std::setw(5) << bots << std::setw(7) << balls << std::fixed << std::setprecision(2)
+                      << std::setw(13) << per_bot << std::setw(13) << batched << std::setw(8) << per_bot / batched << "x"
+                      << std::scientific << std::setprecision(1) << std::setw(10) << max_diff << std::endl;
+        }
+    }
+    std::cout << (all_match ? "Observations identical" : "Observations differ") << std::endl;
+    return all_match ? 0 : 1;
+}
+
+int exportWeights(const std::string& model_path, const std::string& out_path) {
+    MlpPolicy mlp(true);
+    if (!mlp.load(model_path)) return 1;
+    if (!mlp.save(out_path)) {
+        std::cerr << "Cannot write " << out_path << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << out_path << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "";
+    std::string model_path = argc > 2 ? argv[2] : "RobotSoccerTeamA.onnx";
+
+    if (command == "check") {
+        int samples = argc > 3 ? std::stoi(argv[3]) : 100000;
+        double tolerance = argc > 4 ? std::stod(argv[4]) : 1e-5;
+        return check(model_path, samples, tolerance);
+    }
+    if (command == "latency") {
+        return latency(model_path, argc > 3 ? std::stoi(argv[3]) : 10000);
+    }
+    if (command == "replay" && argc > 2) {
+        return replay(argv[2], argc > 3 ? argv[3] : "RobotSoccerTeamA.onnx");
+    }
+    if (command == "observations") {
+        return observations(argc > 2 ? std::stoi(argv[2]) : 20000);
+    }
+    if (command == "export") {
+        return exportWeights(model_path, argc > 3 ? argv[3] : "RobotSoccerTeamA.mlpw");
+    }
+    std::cerr << "Usage: policy_bench check|latency|export [model.onnx] [...]\n"
+              << "       policy_bench replay <worlds.jsonl> [model.onnx]\n"
+              << "       policy_bench observations [iterations]" << std::endl;
+    return 2;
+}
@@ -0,0 +1,111 @@
+#include "policy_reloader.h"
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+constexpr auto WATCH_INTERVAL = std::chrono::seconds(1);
+
+} // namespace
+
+PolicyReloader::PolicyReloader(Factory factory, const std::string& watch_path)
+    : factory(std::move(factory)), watch_path(watch_path) {
+    std::error_code ec;
+    if (!watch_path.empty()) {
+        loaded_time = std::filesystem::last_write_time(watch_path, ec);
+    }
+    pending_time = loaded_time;
+    worker = std::thread(&PolicyReloader::run, this);
+}
+
+PolicyReloader::~PolicyReloader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void PolicyReloader::request() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requested = true;
+    }
+    wake.notify_one();
+}
+
+std::unique_ptr<PolicyBackend> PolicyReloader::takeReady() {
+    if (!has_ready.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    has_ready.store(false, std::memory_order_relaxed);
+    return std::move(ready);
+}
+
+void PolicyReloader::retire(std::unique_ptr<PolicyBackend> old) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired = std::move(old);
+    }
+    wake.notify_one();
+}
+
+bool PolicyReloader::watchedFileChanged() {
+    if (watch_path.empty()) return false;
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(watch_path, ec);
+    if (ec || mtime == loaded_time) return false;
+    if (mtime != pending_time) {
+        pending_time = mtime; // Still being written, or just finished; check again next poll
+        return false;
+    }
+    return true;
+}
+
+void PolicyReloader::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, WATCH_INTERVAL, [&] { return stopping || requested || retired; });
+        if (stopping) break;
+
+        // Destroying an ORT session can take a while; do it here, not on the inference thread
+        std::unique_ptr<PolicyBackend> old = std::move(retired);
+        bool load = requested;
+        requested = false;
+        lock.unlock();
+        old.reset();
+
+        if (watchedFileChanged()) {
+            std::cout << "[AI] " << watch_path << " changed, reloading." << std::endl;
+            load = true;
+        }
+        if (load) {
+            auto started = std::chrono::steady_clock::now();
+            std::error_code ec;
+            auto mtime = watch_path.empty() ? loaded_time : std::filesystem::last_write_time(watch_path, ec);
+            std::unique_ptr<PolicyBackend> next;
+            try {
+                next = factory();
+            } catch (const std::exception& e) {
+                std::cerr << "[AI] Reload failed: " << e.what() << std::endl;
+            }
+            loaded_time = pending_time = mtime; // Don't retry a broken file until it changes again
+            if (next) {
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+                std::cout << "[AI] New " << next->name() << " policy loaded and warmed up in " << ms
+                          << " ms; switching at the next step." << std::endl;
+                lock.lock();
+                old = std::move(ready); // Superseded before it was taken
+                ready = std::move(next);
+                has_ready.store(true, std::memory_order_release);
+                lock.unlock();
+                old.reset();
+            } else {
+                std::cerr << "[AI] Keeping the current policy." << std::endl;
+            }
+        }
+        lock.lock();
+    }
+}
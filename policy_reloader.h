@@ -0,0 +1,59 @@
+#ifndef CAM_ARUCO_POLICY_RELOADER_H
+#define CAM_ARUCO_POLICY_RELOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "policy_backend.h"
+
+// Builds replacement policy backends on a background thread, so a new model
+// can be swapped in without stopping inference. The inference thread polls
+// takeReady() between steps (an atomic load when nothing is pending) and
+// hands the old backend to retire(), which destroys it on the loader thread.
+// A reload is triggered by request(), or by the watched model file changing.
+class PolicyReloader {
+public:
+    // Loads and warms up a backend. Returns nullptr or throws on failure, in
+    // which case the current backend stays in use.
+    using Factory = std::function<std::unique_ptr<PolicyBackend>()>;
+
+    // watch_path: reload when this file's modification time changes and then
+    // stays the same for one poll interval (so a half-copied file isn't
+    // loaded). Empty disables watching.
+    PolicyReloader(Factory factory, const std::string& watch_path);
+    ~PolicyReloader();
+
+    // Safe to call from any thread
+    void request();
+
+    // Non-blocking. The newly loaded backend, if one finished since the last call.
+    std::unique_ptr<PolicyBackend> takeReady();
+
+    // Destroys a replaced backend off the calling thread
+    void retire(std::unique_ptr<PolicyBackend> old);
+
+private:
+    void run();
+    bool watchedFileChanged();
+
+    Factory factory;
+    std::string watch_path;
+    std::filesystem::file_time_type loaded_time;  // mtime of the file currently in use
+    std::filesystem::file_time_type pending_time; // Newer mtime waiting to settle
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool requested = false;
+    bool stopping = false;
+    std::unique_ptr<PolicyBackend> ready;
+    std::unique_ptr<PolicyBackend> retired;
+    std::atomic<bool> has_ready{false};
+    std::thread worker;
+};
+
+#endif //CAM_ARUCO_POLICY_RELOADER_H
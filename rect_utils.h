@@ -0,0 +1,25 @@
+#ifndef CAM_ARUCO_RECT_UTILS_H
+#define CAM_ARUCO_RECT_UTILS_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Replaces overlapping rectangles by their union until none overlap, so a
+// set of search windows covers each pixel at most once.
+inline void mergeOverlappingRects(std::vector<cv::Rect>& rects) {
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < rects.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < rects.size(); ++j) {
+                if ((rects[i] & rects[j]).area() > 0) {
+                    rects[i] |= rects[j];
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+#endif //CAM_ARUCO_RECT_UTILS_H
@@ -0,0 +1,37 @@
+#ifndef CAM_ARUCO_ROLLING_WINDOW_H
+#define CAM_ARUCO_ROLLING_WINDOW_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// The last N samples of a measurement, for percentiles over a recent window.
+// Adding is a single store; percentile() copies the window and partially sorts it.
+template <int N>
+class RollingWindow {
+public:
+    void add(float value) {
+        samples[added % N] = value;
+        ++added;
+    }
+
+    // Samples added so far, including those that have left the window
+    uint64_t count() const { return added; }
+
+    // p in [0, 1] over the samples still in the window; 0 if there are none
+    double percentile(double p) const {
+        int count = int(std::min<uint64_t>(added, N));
+        if (count == 0) return 0.0;
+        std::array<float, N> sorted;
+        std::copy_n(samples.begin(), count, sorted.begin());
+        auto nth = sorted.begin() + std::min(count - 1, int(p * count));
+        std::nth_element(sorted.begin(), nth, sorted.begin() + count);
+        return *nth;
+    }
+
+private:
+    std::array<float, N> samples{};
+    uint64_t added = 0;
+};
+
+#endif //CAM_ARUCO_ROLLING_WINDOW_H
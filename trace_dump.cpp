@@ -0,0 +1,59 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "trace_ring.h"
+
+// Decodes a policy trace file written by AIHandler (ai.trace_path).
+//
+// Usage: trace_dump [trace.bin] [--csv] [--last N]
+//   text: one block per bot and step, as the old console debug output
+//   csv:  one row per bot and step, with wall clock time, observation and actions
+int main(int argc, char** argv) {
+    std::string path = "policy-trace.bin";
+    bool csv = false;
+    size_t last = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (std::strcmp(argv[i], "--last") == 0 && i + 1 < argc) {
+            last = std::stoul(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    std::vector<TraceRecord> records;
+    int64_t wall_offset_ns = 0;
+    if (!TraceRing::read(path, records, wall_offset_ns)) {
+        return 1;
+    }
+    size_t first = (last > 0 && last < records.size()) ? records.size() - last : 0;
+
+    if (csv) {
+        std::cout << "wall_time_ns,call,bot_id";
+        for (int i = 0; i < OBSERVATION_SIZE; ++i) std::cout << ",obs_" << i;
+        std::cout << ",forward,steer,left,right\n" << std::setprecision(9);
+        for (size_t n = first; n < records.size(); ++n) {
+            const TraceRecord& r = records[n];
+            std::cout << int64_t(r.timestamp_ns) + wall_offset_ns << ',' << r.call << ',' << r.bot_id;
+            for (float value : r.observation) std::cout << ',' << value;
+            std::cout << ',' << r.action[0] << ',' << r.action[1] << ',' << r.left << ',' << r.right << '\n';
+        }
+        return 0;
+    }
+
+    uint64_t start_ns = first < records.size() ? records[first].timestamp_ns : 0;
+    uint32_t previous_call = 0;
+    for (size_t n = first; n < records.size(); ++n) {
+        const TraceRecord& r = records[n];
+        if (r.call != previous_call) {
+            std::cout << "\n=== t+" << std::fixed << std::setprecision(3) << (r.timestamp_ns - start_ns) / 1e6 << " ms ===";
+            previous_call = r.call;
+        }
+        printTraceRecord(std::cout, r);
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "trace_ring.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+const char TRACE_MAGIC[4] = {'T', 'R', 'C', 'E'};
+constexpr uint32_t TRACE_VERSION = 1;
+
+} // namespace
+
+TraceRing::~TraceRing() {
+    close();
+}
+
+bool TraceRing::open(const std::string& path, uint32_t capacity) {
+    close();
+    if (capacity == 0) return false;
+
+    std::rename(path.c_str(), (path + ".prev").c_str()); // Fails harmlessly if there is no previous trace
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "[Trace] Cannot create " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    size_t size = RECORDS_OFFSET + size_t(capacity) * sizeof(TraceRecord);
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, off_t(size)) == 0) {
+        mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    ::close(fd); // The mapping keeps the file open
+    if (mapped == MAP_FAILED) {
+        std::cerr << "[Trace] Cannot map " << path << ": " << std::strerror(error) << std::endl;
+        return false;
+    }
+
+    mapped_size = size;
+    header = new (mapped) TraceHeader;
+    std::memcpy(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header->version = TRACE_VERSION;
+    header->record_size = sizeof(TraceRecord);
+    header->capacity = capacity;
+    header->wall_offset_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch() -
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    header->written.store(0, std::memory_order_release);
+    records = reinterpret_cast<TraceRecord*>(static_cast<char*>(mapped) + RECORDS_OFFSET);
+    return true;
+}
+
+void TraceRing::close() {
+    if (header) {
+        munmap(header, mapped_size);
+        header = nullptr;
+        records = nullptr;
+    }
+}
+
+void TraceRing::write(const TraceRecord& record) {
+    if (!header) return;
+    uint64_t n = header->written.load(std::memory_order_relaxed);
+    records[n % header->capacity] = record;
+    header->written.store(n + 1, std::memory_order_release);
+}
+
+bool TraceRing::read(const std::string& path, std::vector<TraceRecord>& out, int64_t& wall_offset_ns) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    uint32_t version = 0, record_size = 0, capacity = 0;
+    uint64_t written = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+    in.read(reinterpret_cast<char*>(&capacity), sizeof(capacity));
+    in.read(reinterpret_cast<char*>(&wall_offset_ns), sizeof(wall_offset_ns));
+    in.read(reinterpret_cast<char*>(&written), sizeof(written));
+    if (!in || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 || version != TRACE_VERSION ||
+        record_size != sizeof(TraceRecord) || capacity == 0) {
+        std::cerr << "[Trace] " << path << " is not a version " << TRACE_VERSION << " trace file" << std::endl;
+        return false;
+    }
+
+    std::vector<TraceRecord> ring(capacity);
+    in.seekg(RECORDS_OFFSET);
+    in.read(reinterpret_cast<char*>(ring.data()), std::streamsize(ring.size() * sizeof(TraceRecord)));
+    if (!in) {
+        std::cerr << "[Trace] " << path << " is truncated" << std::endl;
+        return false;
+    }
+
+    uint64_t count = std::min<uint64_t>(written, capacity);
+    out.clear();
+    out.reserve(count);
+    for (uint64_t n = written - count; n < written; ++n) {
+        out.push_back(ring[n % capacity]);
+    }
+    return true;
+}
+
+void printTraceRecord(std::ostream& out, const TraceRecord& r) {
+    const float* obs = r.observation;
+    out << std::fixed << std::setprecision(3)
+        << "\n--- AI TRACE (Bot ID: " << r.bot_id << ", call " << r.call << ") ---\n"
+        << "INPUT - Self State:  pos(x:" << obs[0] << ", z:" << obs[1] << "), dir(x:" << obs[2] << ", z:" << obs[3] << ")\n"
+        << "INPUT - Teammate:    dist:" << obs[4] << ", dir(x:" << obs[5] << ", z:" << obs[6] << ")\n"
+        << "INPUT - Goal:        dist:" << obs[7] << ", dir(x:" << obs[8] << ", z:" << obs[9] << ")\n";
+    for (int b = 0; b < 4; ++b) {
+        const float* ball = obs + 10 + b * 3;
+        out << "INPUT - Ball " << b + 1 << ":      dist:" << ball[0] << ", dir(x:" << ball[1] << ", z:" << ball[2] << ")\n";
+    }
+    out << "OUTPUT - AI Action:  forward:" << r.action[0] << ", steer:" << r.action[1] << "\n"
+        << "OUTPUT - Motors:     left:" << r.left << ", right:" << r.right << "\n";
+}
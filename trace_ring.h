@@ -0,0 +1,75 @@
+#ifndef CAM_ARUCO_TRACE_RING_H
+#define CAM_ARUCO_TRACE_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "policy_backend.h"
+
+// One bot's policy step: what it saw, what the network said, what was sent.
+struct TraceRecord {
+    uint64_t timestamp_ns; // steady_clock, see TraceHeader::wall_offset_ns
+    uint32_t call;         // predictMovements call number, shared by the bots of one step
+    int32_t bot_id;
+    float observation[OBSERVATION_SIZE];
+    float action[ACTION_SIZE]; // forward, steer
+    float left, right;         // Motor command
+};
+static_assert(sizeof(TraceRecord) == 120, "TraceRecord is a file format");
+
+// Start of the trace file. Records follow at RECORDS_OFFSET.
+struct TraceHeader {
+    char magic[4];          // "TRCE"
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t capacity;      // Records in the ring
+    int64_t wall_offset_ns; // system_clock - steady_clock when the file was created
+    std::atomic<uint64_t> written; // Records written so far; the newest is at (written - 1) % capacity
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "TraceHeader::written is shared through mmap");
+
+// Fixed-size ring of TraceRecords in a memory-mapped file. Writing a record is
+// a 120-byte copy and one atomic store; the kernel writes the pages back on
+// its own, so the trace survives a crash. trace_dump decodes the file.
+// Single writer. A reader of a live file may see the oldest record torn.
+class TraceRing {
+public:
+    enum Level {
+        OFF = 0,    // Nothing
+        RECORD = 1, // Write records to the file
+        PRINT = 2,  // Also print each record to stdout, like the old debug dump
+    };
+    static constexpr size_t RECORDS_OFFSET = 64;
+
+    TraceRing() = default;
+    ~TraceRing();
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    // Creates the file, moving an existing one to <path>.prev so the trace of
+    // a crashed run survives the restart.
+    bool open(const std::string& path, uint32_t capacity);
+    void close();
+
+    // Safe to change from any thread
+    void setLevel(int level) { current_level.store(level, std::memory_order_relaxed); }
+    int level() const { return current_level.load(std::memory_order_relaxed); }
+
+    void write(const TraceRecord& record);
+
+    // Reads the records of a trace file, oldest first, and the file's wall clock offset
+    static bool read(const std::string& path, std::vector<TraceRecord>& records, int64_t& wall_offset_ns);
+
+private:
+    std::atomic<int> current_level{RECORD};
+    TraceHeader* header = nullptr;
+    TraceRecord* records = nullptr;
+    size_t mapped_size = 0;
+};
+
+// Multi-line, human-readable form of a record
+void printTraceRecord(std::ostream& out, const TraceRecord& record);
+
+#endif //CAM_ARUCO_TRACE_RING_H
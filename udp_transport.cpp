@@ -0,0 +1,109 @@
+#include "udp_transport.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// IPv4 and UDP headers, for PublishStats::wireBytes
+constexpr size_t UDP_OVERHEAD = 28;
+// Robot IDs are one byte in the command frame
+constexpr int MAX_ROBOT_ID = 255;
+
+UdpTransport::UdpTransport(const UdpConfig& config) : config(config) {}
+
+UdpTransport::~UdpTransport() {
+    disconnect();
+}
+
+bool UdpTransport::connect() {
+    disconnect();
+    if (config.port < 1 || config.port > 65535 || config.robotPortBase < 1 || config.robotPortBase + MAX_ROBOT_ID > 65535) {
+        std::cerr << "[UDP] udp.port and udp.robot_port_base + " << MAX_ROBOT_ID << " must be in 1-65535." << std::endl;
+        return false;
+    }
+    in_addr address{};
+    if (inet_pton(AF_INET, config.address.c_str(), &address) != 1) {
+        std::cerr << "[UDP] '" << config.address << "' is not an IPv4 address." << std::endl;
+        return false;
+    }
+    destination = address.s_addr;
+
+    // Non-blocking: a full send buffer drops the payload instead of stalling the caller
+    socketFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socketFd < 0) {
+        std::cerr << "[UDP] Cannot create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (IN_MULTICAST(ntohl(destination))) {
+        unsigned char ttl = static_cast<unsigned char>(std::clamp(config.multicastTtl, 0, 255));
+        unsigned char loop = 1; // So a latency probe on this host receives them too
+        setsockopt(socketFd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        setsockopt(socketFd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+        if (!config.multicastInterface.empty()) {
+            in_addr interface_address{};
+            if (inet_pton(AF_INET, config.multicastInterface.c_str(), &interface_address) != 1 ||
+                setsockopt(socketFd, IPPROTO_IP, IP_MULTICAST_IF, &interface_address, sizeof(interface_address)) != 0) {
+                std::cerr << "[UDP] Cannot send multicast from " << config.multicastInterface << "." << std::endl;
+                disconnect();
+                return false;
+            }
+        }
+    }
+    std::cout << "[UDP] Sending to " << config.address << ":" << config.port << "." << std::endl;
+    return true;
+}
+
+void UdpTransport::disconnect() {
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+}
+
+void UdpTransport::send(int robotId, const void* data, size_t size) {
+    if (robotId != ALL_ROBOTS && (robotId < 0 || robotId > MAX_ROBOT_ID)) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++counters.queued;
+        if (counters.failed++ == 0) {
+            std::cerr << "[UDP] No port for robot " << robotId << "." << std::endl;
+        }
+        return;
+    }
+    sockaddr_in target{};
+    target.sin_family = AF_INET;
+    target.sin_addr.s_addr = destination;
+    target.sin_port = htons(uint16_t(robotId == ALL_ROBOTS ? config.port : config.robotPortBase + robotId));
+
+    auto start = std::chrono::steady_clock::now();
+    ssize_t written = socketFd < 0 ? -1
+                                   : sendto(socketFd, data, size, 0, reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+    int error = written < 0 ? (socketFd < 0 ? ENOTCONN : errno) : 0;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    ++counters.queued;
+    if (written == ssize_t(size)) {
+        counters.latencyMs = counters.sent > 0 ? 0.9 * counters.latencyMs + 0.1 * ms : ms;
+        counters.maxLatencyMs = std::max(counters.maxLatencyMs, ms);
+        counters.wireBytes += size + UDP_OVERHEAD;
+        ++counters.sent;
+    } else if (error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS) {
+        ++counters.dropped;
+    } else {
+        // Reported once, not at the command rate
+        if (counters.failed++ == 0) {
+            std::cerr << "[UDP] Send failed: " << std::strerror(error) << std::endl;
+        }
+    }
+}
+
+PublishStats UdpTransport::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return counters;
+}
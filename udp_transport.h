@@ -0,0 +1,34 @@
+#ifndef CAM_ARUCO_UDP_TRANSPORT_H
+#define CAM_ARUCO_UDP_TRANSPORT_H
+
+#include <mutex>
+#include "command_transport.h"
+#include "pipeline_config.h"
+
+// Sends each payload as one UDP datagram, with no broker, connection or
+// acknowledgement: the lowest-latency option. Shared payloads go to
+// address:port, a robot's own payloads to address:(robotPortBase + ID).
+// With a multicast address, every robot joins the group and listens on its
+// ports. Lost datagrams are not resent; the next tick's commands replace
+// them anyway. IPv4 only.
+class UdpTransport : public CommandTransport {
+public:
+    explicit UdpTransport(const UdpConfig& config);
+    ~UdpTransport() override;
+
+    bool connect() override;
+    void disconnect() override;
+    void send(int robotId, const void* data, size_t size) override;
+    PublishStats stats() const override;
+    std::string name() const override { return "udp"; }
+
+private:
+    UdpConfig config;
+    int socketFd = -1;
+    uint32_t destination = 0; // Network byte order
+
+    mutable std::mutex statsMutex;
+    PublishStats counters;
+};
+
+#endif //CAM_ARUCO_UDP_TRANSPORT_H
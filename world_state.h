@@ -1,6 +1,7 @@
 #ifndef WORLD_STATE_H
 #define WORLD_STATE_H
 
+#include <cstdint>
 #include <vector>
 #include <opencv2/core.hpp>
 #include "ball_detector.h"
@@ -18,12 +19,16 @@ struct Bot {
 struct WorldState {
     std::vector<Bot> bots;
     std::vector<Ball> balls; // MODIFIED: Now stores a vector of balls
+    uint64_t frameSeq = 0;      // Camera frame the state was built from
+    uint64_t captureTimeUs = 0; // When that frame was captured, microseconds since the Unix epoch
 };
 
 // JSON serialization functions (no changes needed here)
 inline void to_json(json& j, const Ball& b) {
     j = json{
+            {"id", b.id},
             {"center", {b.center.x, b.center.y}},
+            {"velocity", {b.velocity.x, b.velocity.y}},
             {"radius", b.radius}
     };
 }
@@ -40,8 +45,34 @@ inline void to_json(json& j, const Bot& b) {
 inline void to_json(json& j, const WorldState& w) {
     j = json{
             {"bots", w.bots},
-            {"balls", w.balls} // MODIFIED: Serializes the vector of balls
+            {"balls", w.balls}, // MODIFIED: Serializes the vector of balls
+            {"frame_seq", w.frameSeq},
+            {"capture_time_us", w.captureTimeUs}
     };
 }
 
+// JSON deserialization, for replaying recorded world states
+inline void from_json(const json& j, Ball& b) {
+    b.id = j.value("id", -1);
+    b.center = {j.at("center").at(0).get<float>(), j.at("center").at(1).get<float>()};
+    if (j.contains("velocity")) {
+        b.velocity = {j["velocity"].at(0).get<float>(), j["velocity"].at(1).get<float>()};
+    }
+    b.radius = j.at("radius").get<float>();
+}
+
+inline void from_json(const json& j, Bot& b) {
+    b.id = j.at("id").get<int>();
+    b.center = {j.at("center").at(0).get<float>(), j.at("center").at(1).get<float>()};
+    b.angle = j.at("angle").get<float>();
+    b.is_ai = j.value("is_ai", true);
+}
+
+inline void from_json(const json& j, WorldState& w) {
+    j.at("bots").get_to(w.bots);
+    j.at("balls").get_to(w.balls);
+    w.frameSeq = j.value("frame_seq", uint64_t(0));
+    w.captureTimeUs = j.value("capture_time_us", uint64_t(0));
+}
+
 #endif // WORLD_STATE_H
\ No newline at end of file